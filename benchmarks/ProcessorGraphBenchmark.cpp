@@ -0,0 +1,686 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+// Headless render benchmark for ProcessorGraph. Builds graphs of synthetic processors
+// with a configurable per-sample cost and measures how long they take to render.
+//
+// Usage: ProcessorGraphBenchmark [--cost N] [--seconds S] [--nodes N] [--threads N]
+//                                [--renderer serial|parallel|both] [--topology name]
+//        ProcessorGraphBenchmark --fanin [--seconds S]
+//
+// --fanin compares FanInKernel against adding an input channel's sources one at a time,
+// which is how the render engine summed them before.
+//
+// The allocs column counts every allocation made while rendering, including JUCE's
+// malloc()-based ones, where the C library lets them be intercepted (glibc). Elsewhere it
+// only counts operator new, and is headed "news".
+//
+// Before timing anything, every topology is rendered by both renderers to make sure their
+// outputs match. A failed check ends the run with a non-zero exit code.
+//
+
+#include <playfultones_processorgraph/playfultones_processorgraph.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+//==============================================================================
+namespace
+{
+    std::atomic<bool> countAllocations { false };
+    std::atomic<int64_t> numAllocations { 0 };
+
+    void countAllocation() noexcept
+    {
+        if (countAllocations.load (std::memory_order_relaxed))
+            numAllocations.fetch_add (1, std::memory_order_relaxed);
+    }
+}
+
+#if defined (__GLIBC__)
+// JUCE's HeapBlock, which backs AudioBuffer, MidiBuffer and Array, allocates with malloc() and
+// realloc() rather than operator new, so those are counted too. operator new goes through
+// malloc() as well, and isn't counted a second time.
+extern "C"
+{
+    void* __libc_malloc (std::size_t);
+    void* __libc_calloc (std::size_t, std::size_t);
+    void* __libc_realloc (void*, std::size_t);
+
+    void* malloc (std::size_t size) noexcept                { countAllocation(); return __libc_malloc (size); }
+    void* calloc (std::size_t n, std::size_t size) noexcept { countAllocation(); return __libc_calloc (n, size); }
+    void* realloc (void* p, std::size_t size) noexcept      { countAllocation(); return __libc_realloc (p, size); }
+}
+
+static constexpr bool countsMallocCalls = true;
+#else
+// elsewhere only operator new is replaced, so the count misses HeapBlock's allocations
+static constexpr bool countsMallocCalls = false;
+#endif
+
+namespace
+{
+    void* countedAlloc (std::size_t size)
+    {
+        if (! countsMallocCalls)
+            countAllocation();
+
+        if (auto* p = std::malloc (size != 0 ? size : 1))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    // over-allocates, and keeps the pointer malloc() returned just before the aligned block
+    void* countedAlignedAlloc (std::size_t size, std::align_val_t alignment)
+    {
+        const auto align = std::max ((std::size_t) alignment, sizeof (void*));
+        auto* block = static_cast<char*> (countedAlloc (size + align + sizeof (void*)));
+        auto* aligned = block + sizeof (void*);
+        aligned += (align - (reinterpret_cast<std::uintptr_t> (aligned) % align)) % align;
+        reinterpret_cast<void**> (aligned)[-1] = block;
+        return aligned;
+    }
+
+    void alignedFree (void* p) noexcept
+    {
+        if (p != nullptr)
+            std::free (static_cast<void**> (p)[-1]);
+    }
+
+    template <typename Allocate>
+    void* allocateOrNull (Allocate&& allocate) noexcept
+    {
+        try { return allocate(); }
+        catch (...) { return nullptr; }
+    }
+}
+
+void* operator new (std::size_t size)                                               { return countedAlloc (size); }
+void* operator new[] (std::size_t size)                                             { return countedAlloc (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept               { return allocateOrNull ([=] { return countedAlloc (size); }); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept             { return allocateOrNull ([=] { return countedAlloc (size); }); }
+void* operator new (std::size_t size, std::align_val_t a)                           { return countedAlignedAlloc (size, a); }
+void* operator new[] (std::size_t size, std::align_val_t a)                         { return countedAlignedAlloc (size, a); }
+void* operator new (std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept   { return allocateOrNull ([=] { return countedAlignedAlloc (size, a); }); }
+void* operator new[] (std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return allocateOrNull ([=] { return countedAlignedAlloc (size, a); }); }
+void operator delete (void* p) noexcept                                             { std::free (p); }
+void operator delete[] (void* p) noexcept                                           { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept                                { std::free (p); }
+void operator delete[] (void* p, std::size_t) noexcept                              { std::free (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept                      { std::free (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept                    { std::free (p); }
+void operator delete (void* p, std::align_val_t) noexcept                           { alignedFree (p); }
+void operator delete[] (void* p, std::align_val_t) noexcept                         { alignedFree (p); }
+void operator delete (void* p, std::size_t, std::align_val_t) noexcept              { alignedFree (p); }
+void operator delete[] (void* p, std::size_t, std::align_val_t) noexcept            { alignedFree (p); }
+void operator delete (void* p, std::align_val_t, const std::nothrow_t&) noexcept    { alignedFree (p); }
+void operator delete[] (void* p, std::align_val_t, const std::nothrow_t&) noexcept  { alignedFree (p); }
+
+using namespace juce;
+using namespace PlayfulTones;
+
+namespace PlayfulTones::Benchmarks {
+    //==============================================================================
+    /**
+        A stereo processor that runs a chain of one-pole filters per sample, so that its cost
+        scales linearly with the number of stages.
+    */
+    class SyntheticProcessor final : public AudioProcessor
+    {
+    public:
+        explicit SyntheticProcessor (int numStagesToUse)
+            : AudioProcessor (BusesProperties().withInput ("Input", AudioChannelSet::stereo())
+                                               .withOutput ("Output", AudioChannelSet::stereo())),
+              numStages (jmax (1, numStagesToUse))
+        {
+        }
+
+        const String getName() const override                 { return "Synthetic x" + String (numStages); }
+
+        void prepareToPlay (double, int) override              { std::fill (std::begin (state), std::end (state), 0.0f); }
+        void releaseResources() override                       {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer&) override
+        {
+            for (int ch = 0; ch < jmin (2, buffer.getNumChannels()); ++ch)
+            {
+                auto* data = buffer.getWritePointer (ch);
+                auto z = state[ch];
+
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                {
+                    auto x = data[i];
+
+                    for (int s = 0; s < numStages; ++s)
+                        x = z = z + 0.05f * (x - z);
+
+                    data[i] = x;
+                }
+
+                state[ch] = z;
+            }
+        }
+
+        double getTailLengthSeconds() const override           { return 0.0; }
+        bool acceptsMidi() const override                      { return false; }
+        bool producesMidi() const override                     { return false; }
+        AudioProcessorEditor* createEditor() override          { return nullptr; }
+        bool hasEditor() const override                        { return false; }
+        int getNumPrograms() override                          { return 1; }
+        int getCurrentProgram() override                       { return 0; }
+        void setCurrentProgram (int) override                  {}
+        const String getProgramName (int) override             { return {}; }
+        void changeProgramName (int, const String&) override   {}
+        void getStateInformation (MemoryBlock&) override       {}
+        void setStateInformation (const void*, int) override   {}
+
+    private:
+        const int numStages;
+        float state[2] {};
+    };
+
+    //==============================================================================
+    struct Options
+    {
+        int cost = 16;
+        double seconds = 2.0;
+        int numNodes = 48;
+        int numThreads = -1;
+        bool serial = true;
+        bool parallel = true;
+        bool fanIn = false;
+        String topology;
+    };
+
+    enum FactoryIds
+    {
+        lightModule = 0,
+        heavyModule
+    };
+
+    static ModuleFactory createFactory (int cost)
+    {
+        return ModuleFactory {
+            [cost] { return std::make_unique<SyntheticProcessor> (cost); },
+            [cost] { return std::make_unique<SyntheticProcessor> (cost * 8); }
+        };
+    }
+
+    //==============================================================================
+    /** Adds the graph's audio IO nodes and wires stereo pairs. Must be used inside a transaction. */
+    struct Builder
+    {
+        explicit Builder (ProcessorGraph& g) : graph (g)
+        {
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+            constexpr auto update = AudioProcessorGraph::UpdateKind::none;
+            input = graph.graph.addNode (std::make_unique<IOProcessor> (IOProcessor::audioInputNode), {}, update)->nodeID;
+            output = graph.graph.addNode (std::make_unique<IOProcessor> (IOProcessor::audioOutputNode), {}, update)->nodeID;
+        }
+
+        ProcessorGraph::NodeID add (int factoryId)
+        {
+            return graph.createModule (factoryId)->nodeID;
+        }
+
+        void connect (ProcessorGraph::NodeID src, ProcessorGraph::NodeID dst)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                graph.addConnection ({ { src, ch }, { dst, ch } });
+        }
+
+        ProcessorGraph& graph;
+        ProcessorGraph::NodeID input, output;
+    };
+
+    static void buildChain (Builder& b, int numNodes)
+    {
+        auto previous = b.input;
+
+        for (int i = 0; i < numNodes; ++i)
+        {
+            const auto node = b.add (lightModule);
+            b.connect (previous, node);
+            previous = node;
+        }
+
+        b.connect (previous, b.output);
+    }
+
+    static void buildFanOutFanIn (Builder& b, int numNodes)
+    {
+        const auto split = b.add (lightModule);
+        const auto sum = b.add (lightModule);
+        b.connect (b.input, split);
+
+        for (int i = 0; i < jmax (1, numNodes - 2); ++i)
+        {
+            const auto node = b.add (lightModule);
+            b.connect (split, node);
+            b.connect (node, sum);
+        }
+
+        b.connect (sum, b.output);
+    }
+
+    static void buildDiamonds (Builder& b, int numNodes)
+    {
+        auto top = b.add (lightModule);
+        b.connect (b.input, top);
+
+        for (int i = 0; i < jmax (1, (numNodes - 1) / 3); ++i)
+        {
+            const auto left = b.add (lightModule);
+            const auto right = b.add (heavyModule);
+            const auto bottom = b.add (lightModule);
+
+            b.connect (top, left);
+            b.connect (top, right);
+            b.connect (left, bottom);
+            b.connect (right, bottom);
+            top = bottom;
+        }
+
+        b.connect (top, b.output);
+    }
+
+    static void buildRandomDag (Builder& b, int numNodes)
+    {
+        Random random (0x5eed);
+        std::vector<ProcessorGraph::NodeID> nodes;
+        std::vector<bool> hasOutput;
+
+        for (int i = 0; i < numNodes; ++i)
+        {
+            const auto node = b.add (random.nextInt (4) == 0 ? heavyModule : lightModule);
+
+            if (nodes.empty() || random.nextInt (5) == 0)
+            {
+                b.connect (b.input, node);
+            }
+            else
+            {
+                for (int s = 0; s < 1 + random.nextInt (3); ++s)
+                {
+                    const auto src = random.nextInt ((int) nodes.size());
+                    b.connect (nodes[(size_t) src], node);
+                    hasOutput[(size_t) src] = true;
+                }
+            }
+
+            nodes.push_back (node);
+            hasOutput.push_back (false);
+        }
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (! hasOutput[i])
+                b.connect (nodes[i], b.output);
+    }
+
+    struct Topology
+    {
+        const char* name;
+        void (*build) (Builder&, int numNodes);
+    };
+
+    static const Topology topologies[] {
+        { "chain",      buildChain },
+        { "fanout",     buildFanOutFanIn },
+        { "diamonds",   buildDiamonds },
+        { "random",     buildRandomDag }
+    };
+
+    //==============================================================================
+    struct Result
+    {
+        double nsPerSample = 0.0;
+        double p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+        double budgetMicros = 0.0;
+        int64_t allocations = 0;
+    };
+
+    static double percentile (const std::vector<double>& sorted, double p)
+    {
+        const auto index = jlimit ((size_t) 0, sorted.size() - 1, (size_t) (p * (double) (sorted.size() - 1) + 0.5));
+        return sorted[index];
+    }
+
+    static Result render (ProcessorGraph& graph, double sampleRate, int blockSize, double seconds)
+    {
+        graph.graph.setPlayConfigDetails (2, 2, sampleRate, blockSize);
+        graph.prepareToPlay (sampleRate, blockSize);
+
+        AudioBuffer<float> buffer (2, blockSize);
+        MidiBuffer midi;
+        Random random;
+
+        const auto fillInput = [&]
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+        };
+
+        for (int i = 0; i < 64; ++i)
+        {
+            fillInput();
+            graph.processBlock (buffer, midi);
+        }
+
+        const auto numBlocks = jmax (16, (int) (seconds * sampleRate / blockSize));
+        std::vector<double> blockMicros;
+        blockMicros.reserve ((size_t) numBlocks);
+
+        numAllocations = 0;
+        double totalSeconds = 0.0;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            fillInput();
+            midi.clear();
+
+            countAllocations = true;
+            const auto start = Time::getHighResolutionTicks();
+            graph.processBlock (buffer, midi);
+            const auto elapsed = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+            countAllocations = false;
+
+            totalSeconds += elapsed;
+            blockMicros.push_back (elapsed * 1.0e6);
+        }
+
+        graph.releaseResources();
+
+        std::sort (blockMicros.begin(), blockMicros.end());
+
+        Result r;
+        r.nsPerSample = totalSeconds * 1.0e9 / ((double) numBlocks * blockSize);
+        r.p50 = percentile (blockMicros, 0.5);
+        r.p90 = percentile (blockMicros, 0.9);
+        r.p99 = percentile (blockMicros, 0.99);
+        r.max = blockMicros.back();
+        r.budgetMicros = 1.0e6 * blockSize / sampleRate;
+        r.allocations = numAllocations.load();
+        return r;
+    }
+
+    //==============================================================================
+    static Options parseOptions (const ArgumentList& args)
+    {
+        Options o;
+
+        const auto intValue = [&args] (StringRef name, int fallback)
+        {
+            return args.containsOption (name) ? args.getValueForOption (name).getIntValue() : fallback;
+        };
+
+        o.cost = intValue ("--cost", o.cost);
+        o.numNodes = intValue ("--nodes", o.numNodes);
+        o.numThreads = intValue ("--threads", o.numThreads);
+
+        if (args.containsOption ("--seconds"))
+            o.seconds = args.getValueForOption ("--seconds").getDoubleValue();
+
+        if (args.containsOption ("--renderer"))
+        {
+            const auto renderer = args.getValueForOption ("--renderer");
+            o.serial = renderer != "parallel";
+            o.parallel = renderer != "serial";
+        }
+
+        if (args.containsOption ("--topology"))
+            o.topology = args.getValueForOption ("--topology");
+
+        o.fanIn = args.containsOption ("--fanin");
+
+        return o;
+    }
+
+    //==============================================================================
+    static void mixOneByOne (float* dest, const float* const* sources, const float* gains, int numSources, int numSamples)
+    {
+        FloatVectorOperations::clear (dest, numSamples);
+
+        for (int s = 0; s < numSources; ++s)
+            FloatVectorOperations::addWithMultiply (dest, sources[s], gains[s], numSamples);
+    }
+
+    /** Returns the nanoseconds per output sample of a mixing function. */
+    template <typename MixFunction>
+    static double timeMix (MixFunction&& mix, AudioBuffer<float>& buffer, const std::vector<const float*>& sources,
+                           const std::vector<float>& gains, int blockSize, double seconds)
+    {
+        auto* dest = buffer.getWritePointer (0);
+        const auto numSources = (int) sources.size();
+
+        for (int i = 0; i < 256; ++i)
+            mix (dest, sources.data(), gains.data(), numSources, blockSize);
+
+        int64_t numCalls = 0;
+        double elapsed = 0.0;
+        const auto start = Time::getHighResolutionTicks();
+
+        while (elapsed < seconds)
+        {
+            for (int i = 0; i < 256; ++i)
+                mix (dest, sources.data(), gains.data(), numSources, blockSize);
+
+            numCalls += 256;
+            elapsed = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+        }
+
+        // keeps the result observable, so the calls can't be optimised away
+        static volatile float sink;
+        sink = dest[blockSize - 1];
+
+        return elapsed * 1.0e9 / ((double) numCalls * blockSize);
+    }
+
+    static int runFanIn (const Options& options)
+    {
+        const int sourceCounts[] { 2, 4, 8, 16, 32, 64 };
+        const int blockSizes[] { 32, 64, 256, 1024 };
+        const auto secondsPerCase = options.seconds / 50.0;
+
+        std::cout << String ("sources").paddedLeft (' ', 8)
+                  << String ("block").paddedLeft (' ', 7)
+                  << String ("gains").paddedLeft (' ', 7)
+                  << String ("1-by-1 ns").paddedLeft (' ', 11)
+                  << String ("kernel ns").paddedLeft (' ', 11)
+                  << String ("speedup").paddedLeft (' ', 9) << std::endl;
+
+        Random random (0x5eed);
+
+        for (auto numSources : sourceCounts)
+        {
+            for (auto blockSize : blockSizes)
+            {
+                for (auto withGains : { false, true })
+                {
+                    // laid out like the render plan's buffer pool
+                    AudioBuffer<float> buffer (numSources + 1, blockSize);
+                    std::vector<const float*> sources;
+                    std::vector<float> gains;
+
+                    for (int s = 0; s < numSources; ++s)
+                    {
+                        for (int i = 0; i < blockSize; ++i)
+                            buffer.setSample (s + 1, i, random.nextFloat() * 2.0f - 1.0f);
+
+                        sources.push_back (buffer.getReadPointer (s + 1));
+                        gains.push_back (withGains ? random.nextFloat() : 1.0f);
+                    }
+
+                    const auto oneByOne = timeMix (mixOneByOne, buffer, sources, gains, blockSize, secondsPerCase);
+                    const auto kernel = timeMix (FanInKernel::mix, buffer, sources, gains, blockSize, secondsPerCase);
+
+                    std::cout << String (numSources).paddedLeft (' ', 8)
+                              << String (blockSize).paddedLeft (' ', 7)
+                              << String (withGains ? "yes" : "no").paddedLeft (' ', 7)
+                              << String (oneByOne, 2).paddedLeft (' ', 11)
+                              << String (kernel, 2).paddedLeft (' ', 11)
+                              << String (oneByOne / kernel, 2).paddedLeft (' ', 9) << std::endl;
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    //==============================================================================
+    static ProcessorGraph::RenderConfig createRenderConfig (const Options& options, bool parallel)
+    {
+        return ProcessorGraph::RenderConfig().withParallelRendering (parallel)
+                                             .withNumWorkerThreads (options.numThreads)
+                                             .withBackgroundPlanCompilation (false);
+    }
+
+    static void buildTopology (ProcessorGraph& graph, const Topology& topology, int numNodes)
+    {
+        const ProcessorGraph::ScopedTransaction transaction (graph);
+        Builder builder (graph);
+        topology.build (builder, numNodes);
+    }
+
+    /** Renders the same noise through both renderers, and checks that they produce the same output.
+        A renderer that leaves nodes out would otherwise show up as a speed-up.
+    */
+    static bool checkRenderersMatch (const Topology& topology, const Options& options)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 256;
+        constexpr int numBlocks = 4;
+        constexpr float tolerance = 1.0e-4f;
+
+        std::vector<AudioBuffer<float>> outputs[2];
+
+        for (auto parallel : { false, true })
+        {
+            ProcessorGraph graph (createFactory (options.cost), {}, createRenderConfig (options, parallel));
+            graph.graph.setPlayConfigDetails (2, 2, sampleRate, blockSize);
+            buildTopology (graph, topology, options.numNodes);
+            graph.prepareToPlay (sampleRate, blockSize);
+
+            Random random (0x5eed);
+            MidiBuffer midi;
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                AudioBuffer<float> buffer (2, blockSize);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+                midi.clear();
+                graph.processBlock (buffer, midi);
+                outputs[parallel ? 1 : 0].push_back (std::move (buffer));
+            }
+
+            graph.releaseResources();
+        }
+
+        float maxDifference = 0.0f, maxLevel = 0.0f;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                const auto* expected = outputs[0][(size_t) b].getReadPointer (ch);
+                const auto* actual = outputs[1][(size_t) b].getReadPointer (ch);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    maxDifference = jmax (maxDifference, std::abs (expected[i] - actual[i]));
+                    maxLevel = jmax (maxLevel, std::abs (expected[i]));
+                }
+            }
+        }
+
+        if (maxDifference <= tolerance && maxLevel > 0.0f)
+            return true;
+
+        std::cerr << "renderer outputs differ for " << topology.name
+                  << ": max difference " << maxDifference << ", max level " << maxLevel << std::endl;
+        return false;
+    }
+
+    //==============================================================================
+    static int run (const Options& options)
+    {
+        if (options.fanIn)
+            return runFanIn (options);
+
+        const double sampleRates[] { 44100.0, 48000.0, 96000.0 };
+        const int blockSizes[] { 32, 64, 256, 1024 };
+
+        std::cout << String ("topology").paddedRight (' ', 10)
+                  << String ("nodes").paddedLeft (' ', 6)
+                  << String ("renderer").paddedLeft (' ', 10)
+                  << String ("rate").paddedLeft (' ', 8)
+                  << String ("block").paddedLeft (' ', 7)
+                  << String ("ns/smp").paddedLeft (' ', 10)
+                  << String ("p50 us").paddedLeft (' ', 10)
+                  << String ("p90 us").paddedLeft (' ', 10)
+                  << String ("p99 us").paddedLeft (' ', 10)
+                  << String ("max us").paddedLeft (' ', 10)
+                  << String ("p99 %bud").paddedLeft (' ', 10)
+                  << String (countsMallocCalls ? "allocs" : "news").paddedLeft (' ', 8) << std::endl;
+
+        for (const auto& topology : topologies)
+        {
+            if (options.topology.isNotEmpty() && options.topology != topology.name)
+                continue;
+
+            if (! checkRenderersMatch (topology, options))
+                return 1;
+
+            for (auto parallel : { false, true })
+            {
+                if ((parallel && ! options.parallel) || (! parallel && ! options.serial))
+                    continue;
+
+                ProcessorGraph graph (createFactory (options.cost), {}, createRenderConfig (options, parallel));
+                graph.graph.setPlayConfigDetails (2, 2, sampleRates[0], blockSizes[0]);
+                buildTopology (graph, topology, options.numNodes);
+
+                for (auto sampleRate : sampleRates)
+                {
+                    for (auto blockSize : blockSizes)
+                    {
+                        const auto r = render (graph, sampleRate, blockSize, options.seconds);
+
+                        std::cout << String (topology.name).paddedRight (' ', 10)
+                                  << String (graph.graph.getNumNodes()).paddedLeft (' ', 6)
+                                  << String (parallel ? "parallel" : "serial").paddedLeft (' ', 10)
+                                  << String ((int) sampleRate).paddedLeft (' ', 8)
+                                  << String (blockSize).paddedLeft (' ', 7)
+                                  << String (r.nsPerSample, 2).paddedLeft (' ', 10)
+                                  << String (r.p50, 1).paddedLeft (' ', 10)
+                                  << String (r.p90, 1).paddedLeft (' ', 10)
+                                  << String (r.p99, 1).paddedLeft (' ', 10)
+                                  << String (r.max, 1).paddedLeft (' ', 10)
+                                  << String (100.0 * r.p99 / r.budgetMicros, 1).paddedLeft (' ', 10)
+                                  << String (r.allocations).paddedLeft (' ', 8) << std::endl;
+                    }
+                }
+            }
+        }
+
+        return 0;
+    }
+} // namespace PlayfulTones::Benchmarks
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // creates the message manager without opening a display connection
+    const ScopedJuceInitialiser_GUI juceInitialiser;
+
+    return PlayfulTones::Benchmarks::run (PlayfulTones::Benchmarks::parseOptions ({ argc, argv }));
+}
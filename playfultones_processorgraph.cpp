@@ -9,5 +9,13 @@
 #include "playfultones_processorgraph/playfultones_processorgraph.h"
 
 #include "source/ModuleFactory.cpp"
+#include "source/NodeProfiler.cpp"
+#include "source/NodeStateCache.cpp"
+#include "source/FanInKernel.cpp"
+#include "source/RenderPlan.cpp"
+#include "source/GraphBuildThread.cpp"
+#include "source/PlaceholderProcessor.cpp"
 #include "source/ProcessorGraph.cpp"
+#include "source/RenderEngine.cpp"
+#include "source/PresetBank.cpp"
 #include "source/GraphEditor.cpp"
\ No newline at end of file
@@ -17,7 +17,29 @@ END_JUCE_MODULE_DECLARATION
 #include <juce_audio_utils/juce_audio_utils.h>
 #include <juce_gui_extra/juce_gui_extra.h>
 
+//==============================================================================
+/** Config: PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING
+    Times every node's processBlock() call in the parallel render engine and shows the
+    results in the graph editor. Enabled by default in debug builds only.
+*/
+#ifndef PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING
+ #if JUCE_DEBUG
+  #define PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING 1
+ #else
+  #define PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING 0
+ #endif
+#endif
+
 #include "source/ModuleFactory.h"
 #include "source/ModuleWindow.h"
+#include "source/NodeProfiler.h"
+#include "source/NodeStateCache.h"
+#include "source/FanInKernel.h"
+#include "source/RenderPlan.h"
+#include "source/GraphBuildThread.h"
 #include "source/ProcessorGraph.h"
+#include "source/PlaceholderProcessor.h"
+#include "source/RenderEngine.h"
+#include "source/PresetBank.h"
+#include "source/SpatialGrid.h"
 #include "source/GraphEditor.h"
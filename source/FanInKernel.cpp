@@ -0,0 +1,118 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define PLAYFULTONES_FANIN_USE_SSE 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64)
+ #include <arm_neon.h>
+ #define PLAYFULTONES_FANIN_USE_NEON 1
+#endif
+
+namespace PlayfulTones {
+   #if PLAYFULTONES_FANIN_USE_SSE
+    using FanInVector = __m128;
+    static inline FanInVector fanInLoad (const float* p) noexcept                       { return _mm_loadu_ps (p); }
+    static inline void fanInStore (float* p, FanInVector v) noexcept                    { _mm_storeu_ps (p, v); }
+    static inline FanInVector fanInSplat (float x) noexcept                             { return _mm_set1_ps (x); }
+    static inline FanInVector fanInZero() noexcept                                      { return _mm_setzero_ps(); }
+    static inline FanInVector fanInMulAdd (FanInVector sum, FanInVector a, FanInVector b) noexcept { return _mm_add_ps (sum, _mm_mul_ps (a, b)); }
+   #elif PLAYFULTONES_FANIN_USE_NEON
+    using FanInVector = float32x4_t;
+    static inline FanInVector fanInLoad (const float* p) noexcept                       { return vld1q_f32 (p); }
+    static inline void fanInStore (float* p, FanInVector v) noexcept                    { vst1q_f32 (p, v); }
+    static inline FanInVector fanInSplat (float x) noexcept                             { return vdupq_n_f32 (x); }
+    static inline FanInVector fanInZero() noexcept                                      { return vdupq_n_f32 (0.0f); }
+    static inline FanInVector fanInMulAdd (FanInVector sum, FanInVector a, FanInVector b) noexcept { return vmlaq_f32 (sum, a, b); }
+   #endif
+
+    // Mixes a group of sources into dest in one pass. The pool's channels are only aligned
+    // when the block size is a multiple of four, so unaligned loads are used throughout;
+    // they cost nothing extra on aligned data on current CPUs.
+    template <int numSources, bool shouldAccumulate>
+    static void mixGroup (float* dest, const float* const* sources, const float* gains, int numSamples) noexcept
+    {
+        int i = 0;
+
+       #if PLAYFULTONES_FANIN_USE_SSE || PLAYFULTONES_FANIN_USE_NEON
+        FanInVector g[numSources];
+
+        for (int s = 0; s < numSources; ++s)
+            g[s] = fanInSplat (gains[s]);
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            auto a = shouldAccumulate ? fanInLoad (dest + i) : fanInZero();
+            auto b = shouldAccumulate ? fanInLoad (dest + i + 4) : fanInZero();
+
+            for (int s = 0; s < numSources; ++s)
+            {
+                a = fanInMulAdd (a, fanInLoad (sources[s] + i), g[s]);
+                b = fanInMulAdd (b, fanInLoad (sources[s] + i + 4), g[s]);
+            }
+
+            fanInStore (dest + i, a);
+            fanInStore (dest + i + 4, b);
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            auto sum = shouldAccumulate ? dest[i] : 0.0f;
+
+            for (int s = 0; s < numSources; ++s)
+                sum += sources[s][i] * gains[s];
+
+            dest[i] = sum;
+        }
+    }
+
+    void FanInKernel::mix (float* dest, const float* const* sources, const float* gains, int numSources, int numSamples) noexcept
+    {
+        if (numSources <= 0)
+        {
+            FloatVectorOperations::clear (dest, numSamples);
+            return;
+        }
+
+        // the first group overwrites dest, the rest add to it
+        for (int first = 0; first < numSources; first += 4)
+        {
+            const auto* groupSources = sources + first;
+            const auto* groupGains = gains + first;
+            const auto isFirstGroup = first == 0;
+
+            switch (jmin (4, numSources - first))
+            {
+                case 1:
+                    if (isFirstGroup)
+                        FloatVectorOperations::copyWithMultiply (dest, groupSources[0], groupGains[0], numSamples);
+                    else
+                        FloatVectorOperations::addWithMultiply (dest, groupSources[0], groupGains[0], numSamples);
+                    break;
+
+                case 2:
+                    if (isFirstGroup)
+                        mixGroup<2, false> (dest, groupSources, groupGains, numSamples);
+                    else
+                        mixGroup<2, true> (dest, groupSources, groupGains, numSamples);
+                    break;
+
+                case 3:
+                    if (isFirstGroup)
+                        mixGroup<3, false> (dest, groupSources, groupGains, numSamples);
+                    else
+                        mixGroup<3, true> (dest, groupSources, groupGains, numSamples);
+                    break;
+
+                default:
+                    if (isFirstGroup)
+                        mixGroup<4, false> (dest, groupSources, groupGains, numSamples);
+                    else
+                        mixGroup<4, true> (dest, groupSources, groupGains, numSamples);
+                    break;
+            }
+        }
+    }
+} // namespace PlayfulTones
@@ -0,0 +1,23 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /**
+        Sums the sources of one input channel into it, each scaled by its own gain.
+
+        Adding the sources one at a time reads and writes the destination once per source.
+        This mixes up to four sources per pass, two SIMD registers at a time, so a bus with
+        32 inputs goes over its destination 8 times instead of 32.
+    */
+    struct FanInKernel
+    {
+        /** Overwrites dest with the sum of sources[i] * gains[i], or clears it if there are no sources.
+            The sources mustn't overlap dest.
+        */
+        static void mix (float* dest, const float* const* sources, const float* gains, int numSources, int numSamples) noexcept;
+    };
+} // namespace PlayfulTones
@@ -0,0 +1,36 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+namespace PlayfulTones {
+    GraphBuildThread::GraphBuildThread (const String& threadName, std::function<Build()> getNext, Priority priority)
+        : Thread (threadName), getNextBuild (std::move (getNext))
+    {
+        startThread (priority);
+    }
+
+    GraphBuildThread::~GraphBuildThread()
+    {
+        signalThreadShouldExit();
+        wakeEvent.signal();
+        stopThread (-1);
+    }
+
+    void GraphBuildThread::notify()
+    {
+        wakeEvent.signal();
+    }
+
+    void GraphBuildThread::run()
+    {
+        const std::function<bool()> shouldExit = [this] { return threadShouldExit(); };
+
+        while (! threadShouldExit())
+        {
+            if (auto build = getNextBuild())
+                build (shouldExit);
+            else
+                wakeEvent.wait (-1);
+        }
+    }
+} // namespace PlayfulTones
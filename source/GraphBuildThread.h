@@ -0,0 +1,43 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /**
+        A background thread that builds the processors of saved graphs, one at a time. It's
+        shared by ProcessorGraph's asynchronous loads and PresetBank's prefetching.
+
+        Whenever it's idle or woken with notify(), the thread asks its owner for the next
+        build, and sleeps again when there's none. A build is passed a function that returns
+        true once the thread has been asked to stop, so that it can give up between nodes.
+    */
+    class GraphBuildThread final : private Thread
+    {
+    public:
+        using Build = std::function<void (const std::function<bool()>& shouldExit)>;
+
+        /** Starts the thread. getNextBuild is called on it, and returns an empty function
+            when there's nothing to build.
+        */
+        GraphBuildThread (const String& threadName, std::function<Build()> getNextBuild, Priority = Priority::normal);
+
+        /** Stops the thread, waiting for the build in progress. A processor's
+            setStateInformation() can't be interrupted.
+        */
+        ~GraphBuildThread() override;
+
+        /** Makes the thread ask for a build. */
+        void notify();
+
+    private:
+        void run() override;
+
+        const std::function<Build()> getNextBuild;
+        WaitableEvent wakeEvent;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphBuildThread)
+    };
+} // namespace PlayfulTones
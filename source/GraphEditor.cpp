@@ -113,6 +113,8 @@ namespace PlayfulTones {
 
         ~PluginComponent() override
         {
+            panel.removeFromPinIndex (*this);
+
             if (auto f = graph.graph.getNodeForId (pluginID))
             {
                 if (auto* processor = f->getProcessor())
@@ -152,11 +154,7 @@ namespace PlayfulTones {
 
                 pos += getLocalBounds().getCentre();
 
-                graph.setNodePosition (pluginID,
-                    { pos.x / (double) getParentWidth(),
-                        pos.y / (double) getParentHeight() });
-
-                panel.updateComponents();
+                panel.moveNode (pluginID, panel.toNodePosition (pos));
             }
         }
 
@@ -168,6 +166,7 @@ namespace PlayfulTones {
 
             if (e.mouseWasDraggedSinceMouseDown())
             {
+                panel.applyPendingMoves();
                 graph.graph.sendChangeMessage();
             }
             else if (!e.mods.isPopupMenu() && graph.guiConfig.enableProcessorEditorCreation &&
@@ -224,6 +223,10 @@ namespace PlayfulTones {
             g.setColour (boxColour);
             g.fillRect (boxArea.toFloat());
 
+            // zoomed out too far for the details to be legible
+            if (! panel.isShowingDetail())
+                return;
+
             // Draw hover effect
             if (isHovered)
             {
@@ -235,6 +238,29 @@ namespace PlayfulTones {
             g.setColour (findColour (TextEditor::textColourId));
             g.setFont (font);
             g.drawFittedText (getName(), boxArea, Justification::centred, 2);
+
+           #if PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING
+            if (graph.guiConfig.showNodeTimings)
+                paintTiming (g, boxArea);
+           #endif
+        }
+
+        void paintTiming (Graphics& g, Rectangle<int> boxArea) const
+        {
+            const auto timing = graph.getNodeTiming (pluginID);
+
+            if (! timing.has_value() || timing->numBlocks == 0)
+                return;
+
+            // fully red once a single node takes a quarter of the block
+            const auto heat = (float) jlimit (0.0, 1.0, timing->budgetPercent / 25.0);
+
+            g.setColour (Colours::red.withAlpha (0.45f * heat));
+            g.fillRect (boxArea.toFloat());
+
+            g.setColour (findColour (TextEditor::textColourId).withAlpha (0.8f));
+            g.setFont (font.withHeight (10.0f));
+            g.drawText (String (timing->budgetPercent, 1) + "%", boxArea.reduced (3, 1), Justification::bottomRight, false);
         }
 
         void resized() override
@@ -262,6 +288,13 @@ namespace PlayfulTones {
                     }
                 }
             }
+
+            panel.updatePinIndex (*this);
+        }
+
+        void moved() override
+        {
+            panel.updatePinIndex (*this);
         }
 
         [[nodiscard]] Point<float> getPinPos (int index, bool isInput) const
@@ -273,44 +306,59 @@ namespace PlayfulTones {
             return {};
         }
 
-        void update()
+        [[nodiscard]] static Font getNodeFont()
         {
-            const AudioProcessorGraph::Node::Ptr f (graph.graph.getNodeForId (pluginID));
-            jassert (f != nullptr);
-
-            auto& processor = *f->getProcessor();
+            return { 13.0f, Font::bold };
+        }
 
-            numIns = processor.getTotalNumInputChannels();
-            if (processor.acceptsMidi())
-                ++numIns;
+        [[nodiscard]] static int getNumInputPins (AudioProcessor& processor)
+        {
+            return processor.getTotalNumInputChannels() + (processor.acceptsMidi() ? 1 : 0);
+        }
 
-            numOuts = processor.getTotalNumOutputChannels();
-            if (processor.producesMidi())
-                ++numOuts;
+        [[nodiscard]] static int getNumOutputPins (AudioProcessor& processor)
+        {
+            return processor.getTotalNumOutputChannels() + (processor.producesMidi() ? 1 : 0);
+        }
 
+        /** The size a node's component will have, so the panel can lay out nodes without one. */
+        [[nodiscard]] static Point<int> getSizeFor (AudioProcessor& processor)
+        {
             int w = 100;
             int h = 60;
 
-            w = jmax (w, (jmax (numIns, numOuts) + 1) * 20);
+            w = jmax (w, (jmax (getNumInputPins (processor), getNumOutputPins (processor)) + 1) * 20);
 
-            const int textWidth = font.getStringWidth (processor.getName());
+            const int textWidth = getNodeFont().getStringWidth (processor.getName());
             w = jmax (w, 16 + jmin (textWidth, 300));
             if (textWidth > 300)
                 h = 100;
 
-            setSize (w, h);
+            return { w, h };
+        }
+
+        void update()
+        {
+            const AudioProcessorGraph::Node::Ptr f (graph.graph.getNodeForId (pluginID));
+            jassert (f != nullptr);
+
+            auto& processor = *f->getProcessor();
+
+            numIns = getNumInputPins (processor);
+            numOuts = getNumOutputPins (processor);
+
+            const auto size = getSizeFor (processor);
+            setSize (size.x, size.y);
             setName (processor.getName());
 
-            {
-                auto p = graph.getNodePosition (pluginID);
-                setCentreRelative ((float) p.x, (float) p.y);
-            }
+            setCentrePosition (panel.fromNodePosition (graph.getNodePosition (pluginID)));
 
             if (numIns != numInputs || numOuts != numOutputs)
             {
                 numInputs = numIns;
                 numOutputs = numOuts;
 
+                panel.removeFromPinIndex (*this);
                 pins.clear();
 
                 for (int i = 0; i < processor.getTotalNumInputChannels(); ++i)
@@ -327,6 +375,13 @@ namespace PlayfulTones {
 
                 resized();
             }
+
+            const auto showDetail = panel.isShowingDetail();
+
+            for (auto* pin : pins)
+                pin->setVisible (showDetail);
+
+            setComponentEffect (showDetail ? &shadow : nullptr);
         }
 
         [[nodiscard]] AudioProcessor* getProcessor() const
@@ -347,7 +402,7 @@ namespace PlayfulTones {
             menu->addItem ("Toggle Bypass", graph.guiConfig.enableNodeBypass, false, [this]
                 {
                     if (auto* node = graph.graph.getNodeForId (pluginID))
-                        node->setBypassed (! node->isBypassed());
+                        graph.setNodeBypassed (pluginID, ! node->isBypassed());
 
                     repaint();
                 });
@@ -377,6 +432,7 @@ namespace PlayfulTones {
                 MemoryBlock state;
                 processor->getStateInformation (state);
                 processor->setStateInformation (state.getData(), (int) state.getSize());
+                graph.markDirty (pluginID);
             }
         }
 
@@ -468,6 +524,7 @@ namespace PlayfulTones {
                         MemoryBlock block;
                         stream->readIntoMemoryBlock (block);
                         node->getProcessor()->setStateInformation (block.getData(), (int) block.getSize());
+                        ref->graph.markDirty (ref->pluginID);
                     }
                 }
             };
@@ -482,7 +539,7 @@ namespace PlayfulTones {
         int numInputs = 0, numOutputs = 0;
         int pinSize = 16;
         Point<int> originalPos;
-        Font font { 13.0f, Font::bold };
+        Font font = getNodeFont();
         int numIns = 0, numOuts = 0;
         DropShadowEffect shadow;
         std::unique_ptr<PopupMenu> menu;
@@ -491,6 +548,41 @@ namespace PlayfulTones {
     };
 
 
+    //==============================================================================
+    // builds the stroked cable with its arrow, and the wider outline used for clicking it
+    static void createConnectorPaths (Point<float> p1, Point<float> p2, Path& linePath, Path& hitPath)
+    {
+        linePath.clear();
+        linePath.startNewSubPath (p1);
+        linePath.cubicTo (p1.x, p1.y + (p2.y - p1.y) * 0.33f,
+            p2.x, p1.y + (p2.y - p1.y) * 0.66f,
+            p2.x, p2.y);
+
+        PathStrokeType wideStroke (8.0f);
+        wideStroke.createStrokedPath (hitPath, linePath);
+
+        PathStrokeType stroke (2.5f);
+        stroke.createStrokedPath (linePath, linePath);
+
+        auto arrowW = 5.0f;
+        auto arrowL = 4.0f;
+
+        Path arrow;
+        arrow.addTriangle (-arrowL, arrowW,
+            -arrowL, -arrowW,
+            arrowL, 0.0f);
+
+        arrow.applyTransform (AffineTransform()
+                                  .rotated (MathConstants<float>::halfPi - (float) atan2 (p2.x - p1.x, p2.y - p1.y))
+                                  .translated ((p1 + p2) * 0.5f));
+
+        linePath.addPath (arrow);
+        linePath.setUsingNonZeroWinding (true);
+    }
+
+    // connections can't be grabbed this close to their pins
+    static constexpr float connectorEndClearance = 7.0f;
+
     //==============================================================================
     struct GraphEditorPanel::ConnectorComponent final : public Component,
                                                         public SettableTooltipClient
@@ -590,7 +682,7 @@ namespace PlayfulTones {
                 getDistancesFromEnds (pos, distanceFromStart, distanceFromEnd);
 
                 // avoid clicking the connector when over a pin
-                return distanceFromStart > 7.0 && distanceFromEnd > 7.0;
+                return distanceFromStart > connectorEndClearance && distanceFromEnd > connectorEndClearance;
             }
 
             return false;
@@ -642,35 +734,9 @@ namespace PlayfulTones {
             lastInputPos = p1;
             lastOutputPos = p2;
 
-            p1 -= getPosition().toFloat();
-            p2 -= getPosition().toFloat();
-
-            linePath.clear();
-            linePath.startNewSubPath (p1);
-            linePath.cubicTo (p1.x, p1.y + (p2.y - p1.y) * 0.33f,
-                p2.x, p1.y + (p2.y - p1.y) * 0.66f,
-                p2.x, p2.y);
-
-            PathStrokeType wideStroke (8.0f);
-            wideStroke.createStrokedPath (hitPath, linePath);
-
-            PathStrokeType stroke (2.5f);
-            stroke.createStrokedPath (linePath, linePath);
-
-            auto arrowW = 5.0f;
-            auto arrowL = 4.0f;
-
-            Path arrow;
-            arrow.addTriangle (-arrowL, arrowW,
-                -arrowL, -arrowW,
-                arrowL, 0.0f);
-
-            arrow.applyTransform (AffineTransform()
-                                      .rotated (MathConstants<float>::halfPi - (float) atan2 (p2.x - p1.x, p2.y - p1.y))
-                                      .translated ((p1 + p2) * 0.5f));
-
-            linePath.addPath (arrow);
-            linePath.setUsingNonZeroWinding (true);
+            createConnectorPaths (p1 - getPosition().toFloat(),
+                                  p2 - getPosition().toFloat(),
+                                  linePath, hitPath);
         }
 
         void getDistancesFromEnds (Point<float> p, double& distanceFromStart, double& distanceFromEnd) const
@@ -693,6 +759,258 @@ namespace PlayfulTones {
     };
 
 
+    //==============================================================================
+    /*
+        Draws every connection from cached paths in one component, used instead of the
+        ConnectorComponents when GuiConfig::drawConnectionsInSingleLayer is set. The cables'
+        bounds are kept in a SpatialGrid, so painting only visits the cables inside the
+        clip region and the mouse only tests the cables around it.
+    */
+    struct GraphEditorPanel::ConnectionLayer final : public Component
+    {
+        explicit ConnectionLayer (GraphEditorPanel& p)
+            : panel (p), graph (p.graph)
+        {
+            setAlwaysOnTop (true);
+        }
+
+        /** Drops the connections that are gone or culled, refreshes the moved ones and adds the new ones. */
+        void update()
+        {
+            for (auto it = cables.begin(); it != cables.end();)
+            {
+                if (! panel.isConnectionShown (it->first))
+                {
+                    detach (it->second);
+                    it = cables.erase (it);
+                }
+                else
+                {
+                    refresh (it->second, false);
+                    ++it;
+                }
+            }
+
+            for (auto& c : graph.graph.getConnections())
+            {
+                if (panel.isConnectionShown (c) && cables.find (c) == cables.end())
+                {
+                    auto& cable = cables.try_emplace (c, c).first->second;
+                    cablesByNode[c.source.nodeID].push_back (&cable);
+                    cablesByNode[c.destination.nodeID].push_back (&cable);
+                    refresh (cable, true);
+                }
+            }
+        }
+
+        /** Refreshes only the cables attached to a node. */
+        void nodeMoved (AudioProcessorGraph::NodeID nodeID)
+        {
+            if (const auto it = cablesByNode.find (nodeID); it != cablesByNode.end())
+                for (auto* cable : it->second)
+                    refresh (*cable, false);
+        }
+
+        void paint (Graphics& g) override
+        {
+            const auto area = g.getClipBounds().toFloat();
+
+            for (const auto isMidi : { false, true })
+            {
+                g.setColour (isMidi ? Colours::red : Colours::green);
+
+                grid.forEachIn (area, [&] (Cable* cable, Rectangle<float>)
+                {
+                    if (cable->isMidi == isMidi && cable != hovered)
+                        g.fillPath (cable->linePath);
+                });
+            }
+
+            if (hovered != nullptr)
+            {
+                g.setColour ((hovered->isMidi ? Colours::red : Colours::green).brighter());
+                g.fillPath (hovered->linePath);
+            }
+        }
+
+        bool hitTest (int x, int y) override
+        {
+            if (! graph.guiConfig.nodeConnectionsCanBeModified)
+                return false;
+
+            return findCableAt (Point<int> (x, y).toFloat()) != nullptr;
+        }
+
+        void mouseMove (const MouseEvent& e) override
+        {
+            setHovered (findCableAt (e.position));
+        }
+
+        void mouseExit (const MouseEvent&) override
+        {
+            if (pressed == nullptr)
+                setHovered (nullptr);
+        }
+
+        void mouseDown (const MouseEvent& e) override
+        {
+            dragging = false;
+            pressed = findCableAt (e.position);
+        }
+
+        void mouseDrag (const MouseEvent& e) override
+        {
+            if (dragging)
+            {
+                panel.dragConnector (e);
+            }
+            else if (pressed != nullptr && e.mouseWasDraggedSinceMouseDown())
+            {
+                dragging = true;
+
+                const auto connection = pressed->connection;
+                const bool isNearerSource = e.mouseDownPosition.getDistanceFrom (pressed->p1)
+                                          < e.mouseDownPosition.getDistanceFrom (pressed->p2);
+
+                remove (connection);
+                graph.removeConnection (connection);
+
+                AudioProcessorGraph::NodeAndChannel dummy { {}, 0 };
+
+                panel.beginConnectorDrag (isNearerSource ? dummy : connection.source,
+                    isNearerSource ? connection.destination : dummy,
+                    e);
+            }
+        }
+
+        void mouseUp (const MouseEvent& e) override
+        {
+            pressed = nullptr;
+
+            if (dragging)
+            {
+                dragging = false;
+                panel.endDraggingConnector (e);
+            }
+        }
+
+    private:
+        struct Cable
+        {
+            explicit Cable (const AudioProcessorGraph::Connection& c)
+                : connection (c), isMidi (c.source.isMIDI() || c.destination.isMIDI())
+            {
+            }
+
+            const AudioProcessorGraph::Connection connection;
+            const bool isMidi;
+            Point<float> p1, p2;
+            Path linePath, hitPath;
+            Rectangle<float> bounds;
+        };
+
+        void refresh (Cable& cable, bool force)
+        {
+            Point<float> p1, p2;
+
+            if (auto* src = panel.getComponentForPlugin (cable.connection.source.nodeID))
+                p1 = src->getPinPos (cable.connection.source.channelIndex, false);
+
+            if (auto* dest = panel.getComponentForPlugin (cable.connection.destination.nodeID))
+                p2 = dest->getPinPos (cable.connection.destination.channelIndex, true);
+
+            if (! force && p1 == cable.p1 && p2 == cable.p2)
+                return;
+
+            repaint (cable.bounds.getSmallestIntegerContainer());
+
+            cable.p1 = p1;
+            cable.p2 = p2;
+            createConnectorPaths (p1, p2, cable.linePath, cable.hitPath);
+            cable.bounds = cable.linePath.getBounds().getUnion (cable.hitPath.getBounds()).expanded (1.0f);
+            grid.set (&cable, cable.bounds);
+
+            repaint (cable.bounds.getSmallestIntegerContainer());
+        }
+
+        void remove (const AudioProcessorGraph::Connection& c)
+        {
+            if (const auto it = cables.find (c); it != cables.end())
+            {
+                detach (it->second);
+                cables.erase (it);
+            }
+        }
+
+        // forgets everything that refers to a cable before it's erased
+        void detach (Cable& cable)
+        {
+            for (auto nodeID : { cable.connection.source.nodeID, cable.connection.destination.nodeID })
+            {
+                if (const auto it = cablesByNode.find (nodeID); it != cablesByNode.end())
+                {
+                    auto& attached = it->second;
+                    attached.erase (std::remove (attached.begin(), attached.end(), &cable), attached.end());
+
+                    if (attached.empty())
+                        cablesByNode.erase (it);
+                }
+            }
+
+            if (hovered == &cable)
+                hovered = nullptr;
+
+            if (pressed == &cable)
+                pressed = nullptr;
+
+            grid.remove (&cable);
+            repaint (cable.bounds.getSmallestIntegerContainer());
+        }
+
+        [[nodiscard]] Cable* findCableAt (Point<float> pos) const
+        {
+            Cable* found = nullptr;
+
+            grid.forEachAt (pos, [&] (Cable* cable, Rectangle<float>)
+            {
+                if (found == nullptr
+                    && cable->hitPath.contains (pos)
+                    && cable->p1.getDistanceFrom (pos) > connectorEndClearance
+                    && cable->p2.getDistanceFrom (pos) > connectorEndClearance)
+                    found = cable;
+            });
+
+            return found;
+        }
+
+        void setHovered (Cable* cable)
+        {
+            if (cable == hovered)
+                return;
+
+            for (auto* c : { hovered, cable })
+                if (c != nullptr)
+                    repaint (c->bounds.getSmallestIntegerContainer());
+
+            hovered = cable;
+        }
+
+        GraphEditorPanel& panel;
+        ProcessorGraph& graph;
+
+        // unordered_map never moves its elements, so the grid and the index can point at them
+        std::unordered_map<AudioProcessorGraph::Connection, Cable, ConnectionHash> cables;
+        std::unordered_map<AudioProcessorGraph::NodeID, std::vector<Cable*>, NodeIDHash> cablesByNode;
+        SpatialGrid<Cable*> grid;
+
+        Cable* hovered = nullptr;
+        Cable* pressed = nullptr;
+        bool dragging = false;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConnectionLayer)
+    };
+
+
     //==============================================================================
     GraphEditorPanel::GraphEditorPanel (ProcessorGraph& g)  : graph (g)
     {
@@ -706,6 +1024,30 @@ namespace PlayfulTones {
 
             return nullptr;
         };
+
+        if (graph.guiConfig.useZoomableCanvas)
+        {
+            canvas = std::make_unique<Component>();
+            canvas->setInterceptsMouseClicks (false, true);
+            canvas->setBounds (0, 0, canvasSize, canvasSize);
+            addAndMakeVisible (canvas.get());
+
+            // starts with a stored position of (0, 0) in the top left corner
+            viewOrigin = { (float) canvasSize / 2.0f, (float) canvasSize / 2.0f };
+            canvas->setTransform (AffineTransform::translation (-viewOrigin.x, -viewOrigin.y));
+        }
+
+        if (graph.guiConfig.drawConnectionsInSingleLayer)
+        {
+            connectionLayer = std::make_unique<ConnectionLayer> (*this);
+            getContent().addAndMakeVisible (connectionLayer.get());
+        }
+
+       #if PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING
+        // only the graph's own renderer collects timings, so there's nothing to refresh otherwise
+        if (graph.guiConfig.showNodeTimings && graph.usesOwnRenderer())
+            startTimerHz (10);
+       #endif
     }
 
     GraphEditorPanel::~GraphEditorPanel()
@@ -719,6 +1061,10 @@ namespace PlayfulTones {
         graph.removeListener(this);
         graph.graph.removeChangeListener(this);
         draggingConnector = nullptr;
+        connectionLayer = nullptr;
+        nodeIndex.clear();
+        connectorIndex.clear();
+        connectorsByNode.clear();
         nodes.clear();
         connectors.clear();
     }
@@ -753,6 +1099,8 @@ namespace PlayfulTones {
                 node->setVisible(true);
             for (auto* connector : connectors)
                 connector->setVisible(true);
+            if (connectionLayer != nullptr)
+                connectionLayer->setVisible(true);
         }
     }
 
@@ -765,39 +1113,305 @@ namespace PlayfulTones {
     {
         if (e.mods.isPopupMenu() && graph.guiConfig.enableProcessorCreationMenu)
             showPopupMenu (e.position.toInt());
+
+        panStartOrigin = viewOrigin;
     }
 
-    GraphEditorPanel::PluginComponent* GraphEditorPanel::getComponentForPlugin (AudioProcessorGraph::NodeID nodeID) const
+    void GraphEditorPanel::mouseDrag (const MouseEvent& e)
     {
-        for (auto* fc : nodes)
-            if (fc->pluginID == nodeID)
-                return fc;
+        if (canvas == nullptr || currentEditor != nullptr || e.mods.isPopupMenu())
+            return;
 
-        return nullptr;
+        viewOrigin = panStartOrigin - e.getOffsetFromDragStart().toFloat() / zoom;
+        viewNeedsUpdate = true;
     }
 
-    GraphEditorPanel::ConnectorComponent* GraphEditorPanel::getComponentForConnection (const AudioProcessorGraph::Connection& conn) const
+    void GraphEditorPanel::mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel)
     {
-        for (auto* cc : connectors)
-            if (cc->connection == conn)
-                return cc;
+        if (canvas == nullptr || currentEditor != nullptr)
+            Component::mouseWheelMove (e, wheel);
+        else
+            setZoom (zoom * std::pow (2.0f, wheel.deltaY), e.position);
+    }
 
-        return nullptr;
+    void GraphEditorPanel::mouseMagnify (const MouseEvent& e, float scaleFactor)
+    {
+        if (canvas == nullptr || currentEditor != nullptr)
+            Component::mouseMagnify (e, scaleFactor);
+        else
+            setZoom (zoom * scaleFactor, e.position);
     }
 
-    GraphEditorPanel::PinComponent* GraphEditorPanel::findPinAt (Point<float> pos) const
+    void GraphEditorPanel::setZoom (float newZoom, Point<float> anchor)
     {
-        for (auto* fc : nodes)
+        newZoom = jlimit (minZoom, maxZoom, newZoom);
+
+        // keeps the canvas point under the anchor in place
+        viewOrigin += anchor / zoom - anchor / newZoom;
+        zoom = newZoom;
+        viewNeedsUpdate = true;
+    }
+
+    void GraphEditorPanel::applyViewChange()
+    {
+        if (! viewNeedsUpdate || canvas == nullptr)
+            return;
+
+        viewNeedsUpdate = false;
+        canvas->setTransform (AffineTransform::translation (-viewOrigin.x, -viewOrigin.y).scaled (zoom));
+        updateComponents();
+    }
+
+    Point<double> GraphEditorPanel::toNodePosition (Point<int> contentPosition) const
+    {
+        if (canvas == nullptr)
+            return { contentPosition.x / (double) getWidth(),
+                     contentPosition.y / (double) getHeight() };
+
+        constexpr auto centre = canvasSize / 2;
+
+        return { (jlimit (0, canvasSize, contentPosition.x) - centre) / (double) canvasScreenWidth,
+                 (jlimit (0, canvasSize, contentPosition.y) - centre) / (double) canvasScreenHeight };
+    }
+
+    Point<int> GraphEditorPanel::fromNodePosition (Point<double> nodePosition) const
+    {
+        if (canvas == nullptr)
+            return { roundToInt (getWidth() * nodePosition.x),
+                     roundToInt (getHeight() * nodePosition.y) };
+
+        constexpr auto centre = canvasSize / 2;
+
+        return { jlimit (0, canvasSize, centre + roundToInt (nodePosition.x * canvasScreenWidth)),
+                 jlimit (0, canvasSize, centre + roundToInt (nodePosition.y * canvasScreenHeight)) };
+    }
+
+    bool GraphEditorPanel::isNodeShown (AudioProcessorGraph::NodeID nodeID) const
+    {
+        return graph.graph.getNodeForId (nodeID) != nullptr
+            && (canvas == nullptr || shownNodes.find (nodeID) != shownNodes.end());
+    }
+
+    bool GraphEditorPanel::isConnectionShown (const AudioProcessorGraph::Connection& c) const
+    {
+        return graph.graph.isConnected (c)
+            && (canvas == nullptr || shownConnections.find (c) != shownConnections.end());
+    }
+
+    void GraphEditorPanel::rebuildBoundsIndex()
+    {
+        nodeBoundsIndex.clear();
+        connectionBoundsIndex.clear();
+
+        std::unordered_map<AudioProcessorGraph::NodeID, Rectangle<float>, NodeIDHash> nodeBounds;
+
+        for (auto* node : graph.graph.getNodes())
         {
-            // NB: A Visual Studio optimiser error means we have to put this Component* in a local
-            // variable before trying to cast it, or it gets mysteriously optimised away..
-            auto* comp = fc->getComponentAt (pos.toInt() - fc->getPosition());
+            const auto size = PluginComponent::getSizeFor (*node->getProcessor());
+            const auto bounds = Rectangle<int> (size.x, size.y)
+                                    .withCentre (fromNodePosition (graph.getNodePosition (node->nodeID)))
+                                    .toFloat();
 
-            if (auto* pin = dynamic_cast<PinComponent*> (comp))
-                return pin;
+            nodeBounds[node->nodeID] = bounds;
+            nodeBoundsIndex.set (node->nodeID, bounds);
         }
 
-        return nullptr;
+        // a connection's curve never leaves the box spanned by the nodes at its ends
+        for (auto& c : graph.graph.getConnections())
+            connectionBoundsIndex.set (c, nodeBounds[c.source.nodeID].getUnion (nodeBounds[c.destination.nodeID]));
+
+        boundsIndexIsStale = false;
+    }
+
+    void GraphEditorPanel::updateShownItems()
+    {
+        if (canvas == nullptr)
+            return;
+
+        if (boundsIndexIsStale)
+            rebuildBoundsIndex();
+
+        const auto area = canvas->getLocalArea (this, getLocalBounds()).expanded (cullingMargin).toFloat();
+
+        shownNodes.clear();
+        shownConnections.clear();
+
+        nodeBoundsIndex.forEachIn (area, [this] (AudioProcessorGraph::NodeID nodeID, Rectangle<float>)
+        {
+            shownNodes.insert (nodeID);
+        });
+
+        // the nodes at both ends of a visible connection are needed for its pin positions
+        connectionBoundsIndex.forEachIn (area, [this] (const AudioProcessorGraph::Connection& c, Rectangle<float>)
+        {
+            shownConnections.insert (c);
+            shownNodes.insert (c.source.nodeID);
+            shownNodes.insert (c.destination.nodeID);
+        });
+
+        // never take away a node that's being dragged
+        for (auto* comp : nodes)
+            if (comp->isMouseButtonDown())
+                shownNodes.insert (comp->pluginID);
+    }
+
+    void GraphEditorPanel::timerCallback()
+    {
+        for (auto* node : nodes)
+            if (node->isVisible())
+                node->repaint();
+    }
+
+    size_t GraphEditorPanel::ConnectionHash::operator() (const AudioProcessorGraph::Connection& c) const noexcept
+    {
+        auto hash = (size_t) c.source.nodeID.uid;
+
+        for (auto value : { (size_t) c.source.channelIndex, (size_t) c.destination.nodeID.uid, (size_t) c.destination.channelIndex })
+            hash = hash * 31 + value;
+
+        return hash;
+    }
+
+    GraphEditorPanel::PluginComponent* GraphEditorPanel::addPluginComponent (AudioProcessorGraph::NodeID nodeID)
+    {
+        auto* comp = nodes.add (new PluginComponent (*this, nodeID));
+        nodeIndex[nodeID] = comp;
+        return comp;
+    }
+
+    void GraphEditorPanel::removePluginComponent (int index)
+    {
+        nodeIndex.erase (nodes.getUnchecked (index)->pluginID);
+        nodes.remove (index);
+    }
+
+    GraphEditorPanel::ConnectorComponent* GraphEditorPanel::addConnectorComponent (const AudioProcessorGraph::Connection& c)
+    {
+        auto* comp = connectors.add (new ConnectorComponent (*this));
+        comp->connection = c;
+        connectorIndex[c] = comp;
+        connectorsByNode[c.source.nodeID].push_back (comp);
+        connectorsByNode[c.destination.nodeID].push_back (comp);
+        return comp;
+    }
+
+    void GraphEditorPanel::removeConnectorComponent (int index, bool deleteComponent)
+    {
+        auto* comp = connectors.getUnchecked (index);
+        const auto& c = comp->connection;
+
+        for (auto nodeID : { c.source.nodeID, c.destination.nodeID })
+        {
+            if (auto it = connectorsByNode.find (nodeID); it != connectorsByNode.end())
+            {
+                auto& attached = it->second;
+                attached.erase (std::remove (attached.begin(), attached.end(), comp), attached.end());
+
+                if (attached.empty())
+                    connectorsByNode.erase (it);
+            }
+        }
+
+        connectorIndex.erase (c);
+        connectors.remove (index, deleteComponent);
+    }
+
+    void GraphEditorPanel::moveNode (AudioProcessorGraph::NodeID nodeID, Point<double> relativePosition)
+    {
+        for (auto& move : pendingMoves)
+        {
+            if (move.first == nodeID)
+            {
+                move.second = relativePosition;
+                return;
+            }
+        }
+
+        pendingMoves.emplace_back (nodeID, relativePosition);
+    }
+
+    void GraphEditorPanel::applyPendingMoves()
+    {
+        for (const auto& [nodeID, relativePosition] : pendingMoves)
+        {
+            graph.setNodePosition (nodeID, relativePosition);
+
+            if (auto* comp = getComponentForPlugin (nodeID))
+            {
+                comp->setCentrePosition (fromNodePosition (graph.getNodePosition (nodeID)));
+
+                if (const auto it = connectorsByNode.find (nodeID); it != connectorsByNode.end())
+                    for (auto* cc : it->second)
+                        cc->update();
+
+                if (connectionLayer != nullptr)
+                    connectionLayer->nodeMoved (nodeID);
+            }
+        }
+
+        if (! pendingMoves.empty())
+            boundsIndexIsStale = true;
+
+        pendingMoves.clear();
+    }
+
+    GraphEditorPanel::PluginComponent* GraphEditorPanel::getComponentForPlugin (AudioProcessorGraph::NodeID nodeID) const
+    {
+        const auto it = nodeIndex.find (nodeID);
+        return it != nodeIndex.end() ? it->second : nullptr;
+    }
+
+    GraphEditorPanel::ConnectorComponent* GraphEditorPanel::getComponentForConnection (const AudioProcessorGraph::Connection& conn) const
+    {
+        const auto it = connectorIndex.find (conn);
+        return it != connectorIndex.end() ? it->second : nullptr;
+    }
+
+    void GraphEditorPanel::updatePinIndex (const PluginComponent& comp)
+    {
+        for (auto* pin : comp.pins)
+        {
+            const auto centre = (comp.getPosition() + pin->getBounds().getCentre()).toFloat();
+            pinIndex.set (pin, Rectangle<float> (pinSnapRadius * 2.0f, pinSnapRadius * 2.0f).withCentre (centre));
+        }
+    }
+
+    void GraphEditorPanel::removeFromPinIndex (const PluginComponent& comp)
+    {
+        for (auto* pin : comp.pins)
+            pinIndex.remove (pin);
+    }
+
+    GraphEditorPanel::PinComponent* GraphEditorPanel::findPinNear (Point<float> pos, const AudioProcessorGraph::Connection& dragged) const
+    {
+        // the end being dragged is the one that hasn't been attached to a node yet
+        const bool wantsInput = dragged.destination.nodeID == AudioProcessorGraph::NodeID();
+        const auto& fixedEnd = wantsInput ? dragged.source : dragged.destination;
+
+        PinComponent* nearest = nullptr;
+        auto nearestDistance = pinSnapRadius;
+
+        pinIndex.forEachAt (pos, [&] (PinComponent* pin, Rectangle<float> bounds)
+        {
+            if (pin->isInput != wantsInput || pin->pin.isMIDI() != fixedEnd.isMIDI() || ! pin->isVisible())
+                return;
+
+            const auto distance = bounds.getCentre().getDistanceFrom (pos);
+
+            if (distance > nearestDistance)
+                return;
+
+            auto connection = dragged;
+            (wantsInput ? connection.destination : connection.source) = pin->pin;
+
+            if (graph.graph.canConnect (connection))
+            {
+                nearest = pin;
+                nearestDistance = distance;
+            }
+        });
+
+        return nearest;
     }
 
     static const int headerHeight = 35;
@@ -814,12 +1428,16 @@ namespace PlayfulTones {
         }
         else
         {
+            if (connectionLayer != nullptr)
+                connectionLayer->setBounds (getContent().getLocalBounds());
+
             updateComponents();
         }
     }
 
     void GraphEditorPanel::changeListenerCallback (ChangeBroadcaster*)
     {
+        boundsIndexIsStale = true;
         updateComponents();
 
         for (int i = activeModuleWindows.size(); --i >= 0;)
@@ -839,8 +1457,13 @@ namespace PlayfulTones {
         closeAnyOpenModuleWindows();
     }
 
-    ModuleWindow* GraphEditorPanel::getOrCreateWindowFor (const AudioProcessorGraph::Node::Ptr& node, ModuleWindow::Type type)
+    ModuleWindow* GraphEditorPanel::getOrCreateWindowFor (const AudioProcessorGraph::Node::Ptr& requestedNode, ModuleWindow::Type type)
     {
+        if(requestedNode == nullptr)
+            return nullptr;
+
+        // a lazily restored node gets its real processor before an editor is shown for it
+        const auto node = graph.instantiateNode(requestedNode->nodeID);
         if(node == nullptr)
             return nullptr;
 
@@ -856,6 +1479,8 @@ namespace PlayfulTones {
                     n->setVisible(false);
                 for (auto* connector : connectors)
                     connector->setVisible(false);
+                if (connectionLayer != nullptr)
+                    connectionLayer->setVisible(false);
 
                 // Create back button if needed
                 if (backButton == nullptr)
@@ -942,43 +1567,46 @@ namespace PlayfulTones {
             }
         }
 
+        updateShownItems();
+
         for (int i = nodes.size(); --i >= 0;)
-            if (graph.graph.getNodeForId (nodes.getUnchecked (i)->pluginID) == nullptr)
-                nodes.remove (i);
+            if (! isNodeShown (nodes.getUnchecked (i)->pluginID))
+                removePluginComponent (i);
 
         for (int i = connectors.size(); --i >= 0;)
-            if (! graph.graph.isConnected (connectors.getUnchecked (i)->connection))
-                connectors.remove (i);
+            if (! isConnectionShown (connectors.getUnchecked (i)->connection))
+                removeConnectorComponent (i);
 
         for (auto* fc : nodes)
             fc->update();
 
-        for (auto* cc : connectors)
-            cc->update();
-
         for (auto* f : graph.graph.getNodes())
         {
-            if (getComponentForPlugin (f->nodeID) == nullptr)
+            if (isNodeShown (f->nodeID) && getComponentForPlugin (f->nodeID) == nullptr)
             {
-                auto* comp = nodes.add (new PluginComponent (*this, f->nodeID));
-                addAndMakeVisible (comp);
+                auto* comp = addPluginComponent (f->nodeID);
+                getContent().addAndMakeVisible (comp);
                 comp->update();
             }
         }
 
-        for (auto& c : graph.graph.getConnections())
+        // the connections are updated once the new nodes they may be attached to exist
+        if (connectionLayer != nullptr)
         {
-            if (getComponentForConnection (c) == nullptr)
-            {
-                auto* comp = connectors.add (new ConnectorComponent (*this));
-                addAndMakeVisible (comp);
+            connectionLayer->update();
+            return;
+        }
 
-                comp->setInput (c.source);
-                comp->setOutput (c.destination);
-            }
-            else
+        for (auto* cc : connectors)
+            cc->update();
+
+        for (auto& c : graph.graph.getConnections())
+        {
+            if (isConnectionShown (c) && getComponentForConnection (c) == nullptr)
             {
-                getComponentForConnection (c)->update();
+                auto* comp = addConnectorComponent (c);
+                getContent().addAndMakeVisible (comp);
+                comp->resizeToFit();
             }
         }
     }
@@ -993,27 +1621,40 @@ namespace PlayfulTones {
         {
             addPluginsToMenu (*menu);
 
+            const auto point = toNodePosition (getContent().getLocalPoint (this, mousePos));
+
             menu->showMenuAsync ({},
-                ModalCallbackFunction::create ([this, mousePos] (int r)
+                ModalCallbackFunction::create ([this, point] (int r)
                     {
-                        if (findParentComponentOfClass<GraphEditor>() && r > 0)
-                        {
-                            const auto point = mousePos.toDouble() / Point<double> ((double) getWidth(), (double) getHeight());
-                            graph.createModule(r - 1, point.getX(), point.getY());
-                        }
+                        const auto factoryIds = graph.factory.getFactoryIds();
+
+                        if (findParentComponentOfClass<GraphEditor>() && r > 0 && r <= (int) factoryIds.size())
+                            graph.createModule(factoryIds[(size_t) r - 1], point.getX(), point.getY());
                     }));
         }
     }
 
     void GraphEditorPanel::addPluginsToMenu (PopupMenu& m) const
     {
-        const auto names = graph.factory.getNames();
+        // built from the cached descriptors, so opening the menu never constructs a processor.
+        // Item IDs are 1-based indices into ModuleFactory::getFactoryIds().
+        std::map<String, PopupMenu> categories;
         auto menuID = 1;
-        for (auto& name : names)
+
+        for (auto factoryId : graph.factory.getFactoryIds())
         {
-            m.addItem (menuID, name, true, false);
+            const auto* descriptor = graph.factory.getDescriptor (factoryId);
+
+            if (descriptor->category.isEmpty())
+                m.addItem (menuID, descriptor->name, true, false);
+            else
+                categories[descriptor->category].addItem (menuID, descriptor->name, true, false);
+
             menuID++;
         }
+
+        for (auto& [category, subMenu] : categories)
+            m.addSubMenu (category, subMenu);
     }
 
     void GraphEditorPanel::beginConnectorDrag (AudioProcessorGraph::NodeAndChannel source,
@@ -1021,7 +1662,10 @@ namespace PlayfulTones {
         const MouseEvent& e)
     {
         auto* c = dynamic_cast<ConnectorComponent*> (e.originalComponent);
-        connectors.removeObject (c, false);
+
+        if (const auto index = connectors.indexOf (c); index >= 0)
+            removeConnectorComponent (index, false);
+
         draggingConnector.reset (c);
 
         if (draggingConnector == nullptr)
@@ -1030,7 +1674,7 @@ namespace PlayfulTones {
         draggingConnector->setInput (source);
         draggingConnector->setOutput (dest);
 
-        addAndMakeVisible (draggingConnector.get());
+        getContent().addAndMakeVisible (draggingConnector.get());
         draggingConnector->toFront (false);
 
         dragConnector (e);
@@ -1038,7 +1682,7 @@ namespace PlayfulTones {
 
     void GraphEditorPanel::dragConnector (const MouseEvent& e)
     {
-        auto e2 = e.getEventRelativeTo (this);
+        auto e2 = e.getEventRelativeTo (&getContent());
 
         if (draggingConnector != nullptr)
         {
@@ -1046,24 +1690,10 @@ namespace PlayfulTones {
 
             auto pos = e2.position;
 
-            if (auto* pin = findPinAt (pos))
+            if (auto* pin = findPinNear (pos, draggingConnector->connection))
             {
-                auto connection = draggingConnector->connection;
-
-                if (connection.source.nodeID == AudioProcessorGraph::NodeID() && ! pin->isInput)
-                {
-                    connection.source = pin->pin;
-                }
-                else if (connection.destination.nodeID == AudioProcessorGraph::NodeID() && pin->isInput)
-                {
-                    connection.destination = pin->pin;
-                }
-
-                if (graph.graph.canConnect (connection))
-                {
-                    pos = (pin->getParentComponent()->getPosition() + pin->getBounds().getCentre()).toFloat();
-                    draggingConnector->setTooltip (pin->getTooltip());
-                }
+                pos = (pin->getParentComponent()->getPosition() + pin->getBounds().getCentre()).toFloat();
+                draggingConnector->setTooltip (pin->getTooltip());
             }
 
             if (draggingConnector->connection.source.nodeID == AudioProcessorGraph::NodeID())
@@ -1080,27 +1710,17 @@ namespace PlayfulTones {
 
         draggingConnector->setTooltip ({});
 
-        auto e2 = e.getEventRelativeTo (this);
+        auto e2 = e.getEventRelativeTo (&getContent());
         auto connection = draggingConnector->connection;
 
         draggingConnector = nullptr;
 
-        if (auto* pin = findPinAt (e2.position))
+        if (auto* pin = findPinNear (e2.position, connection))
         {
             if (connection.source.nodeID == AudioProcessorGraph::NodeID())
-            {
-                if (pin->isInput)
-                    return;
-
                 connection.source = pin->pin;
-            }
             else
-            {
-                if (! pin->isInput)
-                    return;
-
                 connection.destination = pin->pin;
-            }
 
             graph.addConnection (connection);
         }
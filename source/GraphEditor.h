@@ -8,11 +8,17 @@ namespace PlayfulTones {
     //==============================================================================
     /**
         A panel that displays and edits a ProcessorGraph.
+
+        With ProcessorGraph::GuiConfig::useZoomableCanvas, the nodes live on a canvas that can
+        be panned by dragging the background and zoomed with the mouse wheel. Only the nodes
+        and connections inside the view get components, and when zoomed out the nodes are
+        drawn as plain boxes.
     */
     class GraphEditorPanel final : public Component,
                                    public ChangeListener,
                                    public Button::Listener,
-                                   private ProcessorGraph::Listener
+                                   private ProcessorGraph::Listener,
+                                   private Timer
     {
     public:
         //==============================================================================
@@ -24,6 +30,9 @@ namespace PlayfulTones {
         void resized() override;
 
         void mouseDown (const MouseEvent&) override;
+        void mouseDrag (const MouseEvent&) override;
+        void mouseWheelMove (const MouseEvent&, const MouseWheelDetails&) override;
+        void mouseMagnify (const MouseEvent&, float scaleFactor) override;
 
         void changeListenerCallback (ChangeBroadcaster*) override;
 
@@ -51,9 +60,64 @@ namespace PlayfulTones {
         struct PluginComponent;
         struct ConnectorComponent;
         struct PinComponent;
+        struct ConnectionLayer;
+
+        struct NodeIDHash
+        {
+            size_t operator() (AudioProcessorGraph::NodeID nodeID) const noexcept    { return std::hash<uint32>() (nodeID.uid); }
+        };
+
+        struct ConnectionHash
+        {
+            size_t operator() (const AudioProcessorGraph::Connection&) const noexcept;
+        };
 
         OwnedArray<PluginComponent> nodes;
         OwnedArray<ConnectorComponent> connectors;
+
+        // lookups into nodes and connectors, kept in sync by the functions below
+        std::unordered_map<AudioProcessorGraph::NodeID, PluginComponent*, NodeIDHash> nodeIndex;
+        std::unordered_map<AudioProcessorGraph::Connection, ConnectorComponent*, ConnectionHash> connectorIndex;
+        std::unordered_map<AudioProcessorGraph::NodeID, std::vector<ConnectorComponent*>, NodeIDHash> connectorsByNode;
+
+        // the centres of every node's pins, in panel coordinates
+        SpatialGrid<PinComponent*> pinIndex;
+        static constexpr float pinSnapRadius = 12.0f;
+
+        // node drags and view changes, applied once per display refresh
+        std::vector<std::pair<AudioProcessorGraph::NodeID, Point<double>>> pendingMoves;
+        bool viewNeedsUpdate = false;
+        VBlankAttachment vBlankAttachment { this, [this] { applyPendingMoves(); applyViewChange(); } };
+
+        // the zoomable canvas, holding the node and connection components when
+        // GuiConfig::useZoomableCanvas is set
+        std::unique_ptr<Component> canvas;
+        Point<float> viewOrigin;
+        Point<float> panStartOrigin;
+        float zoom = 1.0f;
+
+        // the bounds of every node and connection on the canvas, whether or not it has a component
+        SpatialGrid<AudioProcessorGraph::NodeID, NodeIDHash> nodeBoundsIndex { 256.0f };
+        SpatialGrid<AudioProcessorGraph::Connection, ConnectionHash> connectionBoundsIndex { 256.0f };
+        bool boundsIndexIsStale = true;
+
+        // what's inside the view, or near enough to need a component
+        std::unordered_set<AudioProcessorGraph::NodeID, NodeIDHash> shownNodes;
+        std::unordered_set<AudioProcessorGraph::Connection, ConnectionHash> shownConnections;
+
+        // the canvas spans this many pixels each way, with a stored node position of (0, 0) in its
+        // middle, and a stored position of (1, 1) one reference screen further
+        static constexpr int canvasSize = 1 << 17;
+        static constexpr float canvasScreenWidth = 1200.0f, canvasScreenHeight = 800.0f;
+        static constexpr float minZoom = 0.1f, maxZoom = 2.0f;
+        // below this zoom the nodes are drawn as plain boxes, without pins or names
+        static constexpr float detailZoomThreshold = 0.5f;
+        // how far beyond the view components are kept, in canvas pixels
+        static constexpr int cullingMargin = 64;
+
+        // replaces the ConnectorComponents when GuiConfig::drawConnectionsInSingleLayer is set
+        std::unique_ptr<ConnectionLayer> connectionLayer;
+
         std::unique_ptr<ConnectorComponent> draggingConnector;
         std::unique_ptr<PopupMenu> menu;
         OwnedArray<ModuleWindow> activeModuleWindows;
@@ -65,12 +129,45 @@ namespace PlayfulTones {
         AudioProcessorGraph::Node::Ptr currentNode;
         static inline const juce::String embeddedEditorNodeId = "embeddedEditorNodeId";
 
+        PluginComponent* addPluginComponent (AudioProcessorGraph::NodeID);
+        void removePluginComponent (int index);
+        ConnectorComponent* addConnectorComponent (const AudioProcessorGraph::Connection&);
+        void removeConnectorComponent (int index, bool deleteComponent = true);
+
+        /** The component the nodes and connections are placed in: the canvas, or this panel. */
+        [[nodiscard]] Component& getContent() noexcept              { return canvas != nullptr ? *canvas : static_cast<Component&> (*this); }
+
+        /** Convert between the positions stored with the nodes and positions in getContent(). */
+        [[nodiscard]] Point<double> toNodePosition (Point<int> contentPosition) const;
+        [[nodiscard]] Point<int> fromNodePosition (Point<double> nodePosition) const;
+
+        [[nodiscard]] bool isShowingDetail() const noexcept         { return canvas == nullptr || zoom >= detailZoomThreshold; }
+        [[nodiscard]] bool isNodeShown (AudioProcessorGraph::NodeID) const;
+        [[nodiscard]] bool isConnectionShown (const AudioProcessorGraph::Connection&) const;
+
+        void setZoom (float newZoom, Point<float> anchor);
+        void applyViewChange();
+        void rebuildBoundsIndex();
+        void updateShownItems();
+
+        /** Moves a node without refreshing the rest of the panel, on the next display refresh. */
+        void moveNode (AudioProcessorGraph::NodeID, Point<double> relativePosition);
+        void applyPendingMoves();
+
         [[nodiscard]] PluginComponent* getComponentForPlugin (AudioProcessorGraph::NodeID) const;
         [[nodiscard]] ConnectorComponent* getComponentForConnection (const AudioProcessorGraph::Connection&) const;
-        [[nodiscard]] PinComponent* findPinAt (Point<float>) const;
+        /** Keeps a node's pins in pinIndex, called whenever the node or its pins move. */
+        void updatePinIndex (const PluginComponent&);
+        void removeFromPinIndex (const PluginComponent&);
+
+        /** Returns the nearest pin within pinSnapRadius that can take the loose end of a dragged connection. */
+        [[nodiscard]] PinComponent* findPinNear (Point<float>, const AudioProcessorGraph::Connection& dragged) const;
 
         void addPluginsToMenu (PopupMenu& m) const;
 
+        // refreshes the node timing overlay
+        void timerCallback() override;
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphEditorPanel)
     };
 
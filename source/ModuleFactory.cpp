@@ -2,39 +2,100 @@
 // Created by Bence Kovács on 04/01/2024.
 //
 namespace PlayfulTones {
+    ModuleDescriptor ModuleDescriptor::fromProcessor(const juce::AudioProcessor& processor, const juce::String& category)
+    {
+        ModuleDescriptor descriptor;
+        descriptor.name = processor.getName();
+        descriptor.category = category;
+        descriptor.numInputChannels = processor.getTotalNumInputChannels();
+        descriptor.numOutputChannels = processor.getTotalNumOutputChannels();
+        descriptor.acceptsMidi = processor.acceptsMidi();
+        descriptor.producesMidi = processor.producesMidi();
+        descriptor.hasEditor = processor.hasEditor();
+        return descriptor;
+    }
+
+    //==============================================================================
     ModuleFactory::ModuleFactory(std::initializer_list<Constructor> cCollection)
-            : constructors(createMapFromCollection(cCollection))
+            : entries(createMapFromCollection(cCollection))
     {
     }
 
     ModuleFactory::ModuleFactory(const std::vector<Constructor>& cCollection)
-            : constructors(createMapFromCollection(cCollection))
+            : entries(createMapFromCollection(cCollection))
     {
     }
 
     ModuleFactory::ModuleFactory(std::unordered_map<int, Constructor> cCollection)
-            : constructors(std::move(cCollection))
+            : entries(createMapFromMap(cCollection))
+    {
+    }
+
+    ModuleFactory::ModuleFactory(std::initializer_list<Registration> rCollection)
+            : entries(createMapFromCollection(rCollection))
+    {
+    }
+
+    ModuleFactory::ModuleFactory(const std::vector<Registration>& rCollection)
+            : entries(createMapFromCollection(rCollection))
+    {
+    }
+
+    ModuleFactory::ModuleFactory(const std::unordered_map<int, Registration>& rCollection)
+            : entries(createMapFromMap(rCollection))
+    {
+    }
+
+    ModuleFactory::ModuleFactory(std::map<int, Entry> e)
+            : entries(std::move(e))
     {
     }
 
     juce::StringArray ModuleFactory::getNames() const
     {
         juce::StringArray names;
-        std::map<int, Constructor> orderedConstructors(constructors.begin(), constructors.end());
-        for (const auto& pair : orderedConstructors)
-            names.add(pair.second()->getName());
+        for (const auto& pair : entries)
+            names.add(getDescriptor(pair.first)->name);
         return names;
     }
 
+    std::vector<int> ModuleFactory::getFactoryIds() const
+    {
+        std::vector<int> ids;
+        ids.reserve(entries.size());
+        for (const auto& pair : entries)
+            ids.push_back(pair.first);
+        return ids;
+    }
+
+    const ModuleDescriptor* ModuleFactory::getDescriptor(int factoryId) const
+    {
+        const auto it = entries.find(factoryId);
+        if (it == entries.end())
+            return nullptr;
+
+        auto& entry = it->second;
+        if (! entry.descriptor.has_value())
+        {
+            // registered without a descriptor, so the only way to find out is to ask a processor
+            if (auto processor = entry.instantiate())
+                entry.descriptor = ModuleDescriptor::fromProcessor(*processor);
+            else
+                entry.descriptor = ModuleDescriptor();
+        }
+
+        return &*entry.descriptor;
+    }
+
     std::unique_ptr<juce::AudioProcessor> ModuleFactory::createProcessor(int index)
     {
-        if (auto it = constructors.find(index); it != constructors.end())
-            return it->second();
+        if (auto it = entries.find(index); it != entries.end())
+            return it->second.instantiate();
         return nullptr;
     }
 
     int ModuleFactory::getNumModules() const
     {
-        return static_cast<int>(constructors.size());
+        return static_cast<int>(entries.size());
     }
-} // namespace PlayfulTones
\ No newline at end of file
+} // namespace PlayfulTones
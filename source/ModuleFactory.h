@@ -2,30 +2,158 @@
 // Created by Bence Kovács on 04/01/2024.
 //
 namespace PlayfulTones {
+    /**
+        What a module is, known without constructing its processor.
+    */
+    struct ModuleDescriptor
+    {
+        juce::String name;
+        juce::String category;
+        int numInputChannels = 0;
+        int numOutputChannels = 0;
+        bool acceptsMidi = false;
+        bool producesMidi = false;
+        bool hasEditor = false;
+
+        /** Reads a descriptor off an existing processor. */
+        static ModuleDescriptor fromProcessor(const juce::AudioProcessor& processor, const juce::String& category = {});
+    };
+
+    /**
+        Returns the stable factory ID of a module type, hashed (FNV-1a) from the type's
+        `static constexpr const char* moduleId`. Unlike positional IDs, it doesn't change
+        when modules are added or reordered, so saved graphs keep referring to the right type.
+    */
+    template <typename Processor>
+    constexpr int getModuleTypeId() noexcept
+    {
+        std::uint32_t hash = 2166136261u;
+        for (auto* c = Processor::moduleId; *c != 0; ++c)
+            hash = (hash ^ static_cast<std::uint8_t>(*c)) * 16777619u;
+        return static_cast<int>(hash & 0x7fffffffu);
+    }
+
+    /** The compile-time view of a set of module types. */
+    template <typename... Processors>
+    struct ModuleTypeList
+    {
+        static constexpr int numModules = static_cast<int>(sizeof...(Processors));
+        static constexpr std::array<int, sizeof...(Processors)> typeIds { getModuleTypeId<Processors>()... };
+
+        static constexpr bool hasUniqueIds() {
+            for (size_t i = 0; i < typeIds.size(); ++i)
+                for (size_t j = i + 1; j < typeIds.size(); ++j)
+                    if (typeIds[i] == typeIds[j])
+                        return false;
+            return true;
+        }
+    };
+
     class ModuleFactory final
     {
     public:
         using Constructor = std::function<std::unique_ptr<juce::AudioProcessor>()>;
+        using CreateFunction = std::unique_ptr<juce::AudioProcessor> (*)();
+
+        /**
+            Creates a factory for a fixed set of processor types, e.g. make<Gain, Delay>().
+
+            Each type must be default-constructible and declare a
+            `static constexpr const char* moduleId`, which its factory ID is derived from.
+            A type can also provide a `static ModuleDescriptor getModuleDescriptor()`, so
+            describing it never needs an instance. Processors are created through a plain
+            function pointer rather than a std::function.
+
+            @see getModuleTypeId, ModuleTypeList
+        */
+        template <typename... Processors>
+        static ModuleFactory make() {
+            static_assert(ModuleTypeList<Processors...>::hasUniqueIds(), "Two module types share a moduleId hash");
+            std::map<int, Entry> map;
+            (map.insert({getModuleTypeId<Processors>(), createTypedEntry<Processors>()}), ...);
+            return ModuleFactory(std::move(map));
+        }
+
+        /** A constructor registered together with its descriptor. */
+        struct Registration
+        {
+            ModuleDescriptor descriptor;
+            Constructor constructor;
+        };
 
         ModuleFactory(std::initializer_list<Constructor> constructors);
         ModuleFactory(const std::vector<Constructor>& constructors);
         ModuleFactory(std::unordered_map<int, Constructor> constructors);
+
+        ModuleFactory(std::initializer_list<Registration> registrations);
+        ModuleFactory(const std::vector<Registration>& registrations);
+        ModuleFactory(const std::unordered_map<int, Registration>& registrations);
+
         [[nodiscard]] juce::StringArray getNames() const;
 
+        /** Returns the registered factory IDs in ascending order. */
+        [[nodiscard]] std::vector<int> getFactoryIds() const;
+
+        /** Returns the descriptor for a factory ID, or nullptr if there's no such module.
+            Modules registered without a descriptor are constructed once, the first time they're
+            described, and the result is cached. Must be called on the message thread.
+        */
+        [[nodiscard]] const ModuleDescriptor* getDescriptor(int factoryId) const;
+
         std::unique_ptr<juce::AudioProcessor> createProcessor(int index);
         [[nodiscard]] int getNumModules() const;
 
     private:
-        const std::unordered_map<int, Constructor> constructors;
+        struct Entry
+        {
+            [[nodiscard]] std::unique_ptr<juce::AudioProcessor> instantiate() const {
+                return create != nullptr ? create() : constructor();
+            }
+
+            Constructor constructor;
+            CreateFunction create = nullptr;
+            mutable std::optional<ModuleDescriptor> descriptor;
+        };
+
+        template <typename P, typename = void>
+        struct HasStaticDescriptor : std::false_type {};
+
+        template <typename P>
+        struct HasStaticDescriptor<P, std::void_t<decltype(P::getModuleDescriptor())>> : std::true_type {};
+
+        explicit ModuleFactory(std::map<int, Entry> entries);
+
+        const std::map<int, Entry> entries;
 
         template <typename Collection>
-        static std::unordered_map<int, Constructor> createMapFromCollection(const Collection& collection) {
-            std::unordered_map<int, Constructor> map;
+        static std::map<int, Entry> createMapFromCollection(const Collection& collection) {
+            std::map<int, Entry> map;
             int index = 0;
             for (const auto& item : collection) {
-                map.insert({index++, item});
+                map.insert({index++, createEntry(item)});
+            }
+            return map;
+        }
+
+        template <typename Map>
+        static std::map<int, Entry> createMapFromMap(const Map& source) {
+            std::map<int, Entry> map;
+            for (const auto& [id, item] : source) {
+                map.insert({id, createEntry(item)});
             }
             return map;
         }
+
+        static Entry createEntry(const Constructor& constructor) { return { constructor, nullptr, std::nullopt }; }
+        static Entry createEntry(const Registration& registration) { return { registration.constructor, nullptr, registration.descriptor }; }
+
+        template <typename Processor>
+        static Entry createTypedEntry() {
+            Entry entry;
+            entry.create = [] () -> std::unique_ptr<juce::AudioProcessor> { return std::make_unique<Processor>(); };
+            if constexpr (HasStaticDescriptor<Processor>::value)
+                entry.descriptor = Processor::getModuleDescriptor();
+            return entry;
+        }
     };
-} // namespace PlayfulTones
\ No newline at end of file
+} // namespace PlayfulTones
@@ -0,0 +1,119 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+namespace PlayfulTones {
+    void NodeTimingStatistics::record (int64 elapsedTicks, int numSamples, double sampleRate) noexcept
+    {
+        if (resetRequested.exchange (false, std::memory_order_relaxed))
+        {
+            maxTicks.store (0, std::memory_order_relaxed);
+            totalTicks.store (0, std::memory_order_relaxed);
+            numCalls.store (0, std::memory_order_relaxed);
+        }
+
+        lastTicks.store (elapsedTicks, std::memory_order_relaxed);
+        maxTicks.store (jmax (maxTicks.load (std::memory_order_relaxed), elapsedTicks), std::memory_order_relaxed);
+        totalTicks.store (totalTicks.load (std::memory_order_relaxed) + elapsedTicks, std::memory_order_relaxed);
+        numCalls.store (numCalls.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        if (numSamples > 0 && sampleRate > 0.0)
+            lastBudgetFraction.store (Time::highResolutionTicksToSeconds (elapsedTicks) * sampleRate / numSamples,
+                                      std::memory_order_relaxed);
+    }
+
+    NodeTiming NodeTimingStatistics::getSnapshot() const noexcept
+    {
+        const auto toMicros = [] (int64 ticks) { return Time::highResolutionTicksToSeconds (ticks) * 1.0e6; };
+
+        NodeTiming timing;
+        timing.numBlocks = numCalls.load (std::memory_order_relaxed);
+        timing.lastMicros = toMicros (lastTicks.load (std::memory_order_relaxed));
+        timing.maxMicros = toMicros (maxTicks.load (std::memory_order_relaxed));
+        timing.budgetPercent = lastBudgetFraction.load (std::memory_order_relaxed) * 100.0;
+
+        if (timing.numBlocks > 0)
+            timing.meanMicros = toMicros (totalTicks.load (std::memory_order_relaxed)) / (double) timing.numBlocks;
+
+        return timing;
+    }
+
+    //==============================================================================
+    void NodeSleepStatistics::record (bool skipped) noexcept
+    {
+        if (resetRequested.exchange (false, std::memory_order_relaxed))
+        {
+            numProcessed.store (0, std::memory_order_relaxed);
+            numSkipped.store (0, std::memory_order_relaxed);
+        }
+
+        auto& counter = skipped ? numSkipped : numProcessed;
+        counter.store (counter.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        asleep.store (skipped, std::memory_order_relaxed);
+    }
+
+    NodeSleepState NodeSleepStatistics::getSnapshot() const noexcept
+    {
+        NodeSleepState state;
+        state.isAsleep = asleep.load (std::memory_order_relaxed);
+        state.numBlocksProcessed = numProcessed.load (std::memory_order_relaxed);
+        state.numBlocksSkipped = numSkipped.load (std::memory_order_relaxed);
+        return state;
+    }
+
+    //==============================================================================
+    std::shared_ptr<NodeProfiler::Entry> NodeProfiler::getStatisticsFor (const AudioProcessorGraph::Node& node)
+    {
+        const ScopedLock sl (lock);
+        auto& stats = statistics[&node];
+
+        if (stats == nullptr)
+            stats = std::make_shared<Entry>();
+
+        return stats;
+    }
+
+    std::optional<NodeTiming> NodeProfiler::getTiming (const AudioProcessorGraph::Node& node) const
+    {
+        const ScopedLock sl (lock);
+        const auto it = statistics.find (&node);
+
+        if (it == statistics.end())
+            return std::nullopt;
+
+        return it->second->timing.getSnapshot();
+    }
+
+    std::optional<NodeSleepState> NodeProfiler::getSleepState (const AudioProcessorGraph::Node& node) const
+    {
+        const ScopedLock sl (lock);
+        const auto it = statistics.find (&node);
+
+        if (it == statistics.end())
+            return std::nullopt;
+
+        return it->second->sleep.getSnapshot();
+    }
+
+    void NodeProfiler::reset()
+    {
+        const ScopedLock sl (lock);
+
+        for (auto& [node, stats] : statistics)
+        {
+            stats->timing.reset();
+            stats->sleep.reset();
+        }
+    }
+
+    void NodeProfiler::removeStale (const std::vector<AudioProcessorGraph::Node::Ptr>& nodes)
+    {
+        const ScopedLock sl (lock);
+
+        for (auto it = statistics.begin(); it != statistics.end();)
+        {
+            const auto isLive = std::any_of (nodes.begin(), nodes.end(), [node = it->first] (auto& n) { return n.get() == node; });
+            it = isLive ? std::next (it) : statistics.erase (it);
+        }
+    }
+} // namespace PlayfulTones
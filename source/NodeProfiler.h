@@ -0,0 +1,96 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /** A snapshot of the time a node has spent in processBlock(). */
+    struct NodeTiming
+    {
+        double lastMicros = 0.0;
+        double meanMicros = 0.0;
+        double maxMicros = 0.0;
+        /** The share of the last block's real-time budget, in percent. */
+        double budgetPercent = 0.0;
+        int64 numBlocks = 0;
+    };
+
+    /** A snapshot of how often a node has been put to sleep by silence detection. */
+    struct NodeSleepState
+    {
+        bool isAsleep = false;
+        int64 numBlocksProcessed = 0;
+        int64 numBlocksSkipped = 0;
+    };
+
+    //==============================================================================
+    /**
+        Running timing statistics for one node.
+
+        Only the thread that renders the node writes to it, so every field can be a plain
+        relaxed atomic. Resets are requested by the reader and carried out by the writer.
+    */
+    class NodeTimingStatistics
+    {
+    public:
+        void record (int64 elapsedTicks, int numSamples, double sampleRate) noexcept;
+        [[nodiscard]] NodeTiming getSnapshot() const noexcept;
+        void reset() noexcept     { resetRequested.store (true, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64> lastTicks { 0 }, maxTicks { 0 }, totalTicks { 0 }, numCalls { 0 };
+        std::atomic<double> lastBudgetFraction { 0.0 };
+        std::atomic<bool> resetRequested { false };
+    };
+
+    /** Counts the blocks a node was processed or skipped for. Written by the rendering thread only. */
+    class NodeSleepStatistics
+    {
+    public:
+        void record (bool skipped) noexcept;
+        [[nodiscard]] NodeSleepState getSnapshot() const noexcept;
+        void reset() noexcept     { resetRequested.store (true, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64> numProcessed { 0 }, numSkipped { 0 };
+        std::atomic<bool> asleep { false }, resetRequested { false };
+    };
+
+    //==============================================================================
+    /**
+        Owns the statistics of every node a RenderEngine renders. The statistics outlive
+        the render plans that point at them, so they survive topology changes.
+
+        Statistics belong to a node object rather than its ID: a loaded graph reuses the IDs
+        of the nodes it replaces, and both are rendered while the two plans crossfade.
+    */
+    class NodeProfiler
+    {
+    public:
+        struct Entry
+        {
+            NodeTimingStatistics timing;
+            NodeSleepStatistics sleep;
+
+            // silence tracking, only touched by the thread that renders the node
+            int64 numSilentSamples = 0;
+            bool isAsleep = false;
+        };
+
+        /** Returns the statistics for a node, creating them if needed. */
+        std::shared_ptr<Entry> getStatisticsFor (const AudioProcessorGraph::Node&);
+
+        [[nodiscard]] std::optional<NodeTiming> getTiming (const AudioProcessorGraph::Node&) const;
+        [[nodiscard]] std::optional<NodeSleepState> getSleepState (const AudioProcessorGraph::Node&) const;
+        void reset();
+
+        /** Forgets the statistics of nodes that aren't part of the given topology. */
+        void removeStale (const std::vector<AudioProcessorGraph::Node::Ptr>& nodes);
+
+    private:
+        CriticalSection lock;
+        std::unordered_map<const AudioProcessorGraph::Node*, std::shared_ptr<Entry>> statistics;
+    };
+} // namespace PlayfulTones
@@ -0,0 +1,123 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+namespace PlayfulTones {
+    NodeStateCache::Entry::Entry (AudioProcessorGraph::Node::Ptr n)
+        : node (std::move (n))
+    {
+        node->getProcessor()->addListener (this);
+    }
+
+    NodeStateCache::Entry::~Entry()
+    {
+        // the entry holds a reference to the node, so the processor is still alive
+        node->getProcessor()->removeListener (this);
+    }
+
+    void NodeStateCache::Entry::audioProcessorParameterChanged (AudioProcessor*, int, float)
+    {
+        dirty.store (true, std::memory_order_release);
+    }
+
+    void NodeStateCache::Entry::audioProcessorChanged (AudioProcessor*, const ChangeDetails& details)
+    {
+        if (details.nonParameterStateChanged || details.programChanged || details.parameterInfoChanged)
+            dirty.store (true, std::memory_order_release);
+    }
+
+    //==============================================================================
+    NodeStateCache::~NodeStateCache()
+    {
+        clear();
+    }
+
+    void NodeStateCache::beginSave()
+    {
+        const ScopedLock sl (lock);
+        statistics.numSerialized = 0;
+        statistics.numReused = 0;
+    }
+
+    NodeStateCache::State NodeStateCache::getState (const AudioProcessorGraph::Node::Ptr& node)
+    {
+        const ScopedLock sl (lock);
+
+        auto& entry = entries[node->nodeID.uid];
+
+        // a new node may have been given the ID of one that was removed
+        if (entry == nullptr || entry->node != node)
+            entry = std::make_unique<Entry> (node);
+
+        // cleared before serializing, so that a change made meanwhile invalidates the result
+        if (entry->dirty.exchange (false, std::memory_order_acq_rel) || entry->state.data == nullptr)
+        {
+            auto state = std::make_shared<MemoryBlock>();
+            node->getProcessor()->getStateInformation (*state);
+            entry->state.hash = hashState (*state);
+            entry->state.data = std::move (state);
+
+            ++statistics.numSerialized;
+            ++statistics.totalSerialized;
+        }
+        else
+        {
+            ++statistics.numReused;
+            ++statistics.totalReused;
+        }
+
+        return entry->state;
+    }
+
+    uint64 NodeStateCache::hashState (const MemoryBlock& state) noexcept
+    {
+        auto hash = (uint64) 0xcbf29ce484222325;
+        const auto* bytes = static_cast<const uint8*> (state.getData());
+
+        for (size_t i = 0; i < state.getSize(); ++i)
+            hash = (hash ^ bytes[i]) * (uint64) 0x100000001b3;
+
+        return hash;
+    }
+
+    void NodeStateCache::markDirty (AudioProcessorGraph::NodeID nodeID)
+    {
+        const ScopedLock sl (lock);
+
+        if (auto it = entries.find (nodeID.uid); it != entries.end())
+            it->second->dirty.store (true, std::memory_order_release);
+    }
+
+    void NodeStateCache::markAllDirty()
+    {
+        const ScopedLock sl (lock);
+
+        for (auto& [uid, entry] : entries)
+            entry->dirty.store (true, std::memory_order_release);
+    }
+
+    void NodeStateCache::removeStale (const AudioProcessorGraph& graph)
+    {
+        const ScopedLock sl (lock);
+
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (graph.getNodeForId (it->second->node->nodeID) != it->second->node.get())
+                it = entries.erase (it);
+            else
+                ++it;
+        }
+    }
+
+    void NodeStateCache::clear()
+    {
+        const ScopedLock sl (lock);
+        entries.clear();
+    }
+
+    StateCacheStatistics NodeStateCache::getStatistics() const
+    {
+        const ScopedLock sl (lock);
+        return statistics;
+    }
+} // namespace PlayfulTones
@@ -0,0 +1,85 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /** How many nodes a save had to serialize, and how many it took from the cache. */
+    struct StateCacheStatistics
+    {
+        /** Counts for the most recent save. */
+        int numSerialized = 0;
+        int numReused = 0;
+
+        /** Counts since the cache was created. */
+        int64 totalSerialized = 0;
+        int64 totalReused = 0;
+    };
+
+    //==============================================================================
+    /**
+        Keeps the last getStateInformation() result of every node, so that saving a graph only
+        serializes the processors whose state may have changed since the previous save.
+
+        A node's state is invalidated when one of its parameters changes, when its processor
+        reports a program or non-parameter state change through updateHostDisplay(), or when
+        markDirty() is called. Processors that change their state without telling the host
+        must be marked dirty explicitly.
+    */
+    class NodeStateCache
+    {
+    public:
+        NodeStateCache() = default;
+        ~NodeStateCache();
+
+        /** A serialized processor state and the hash of its bytes. */
+        struct State
+        {
+            std::shared_ptr<const MemoryBlock> data;
+            uint64 hash = 0;
+        };
+
+        /** Call before saving a graph, to start counting a new save. */
+        void beginSave();
+
+        /** Returns the node's processor state, serializing it only if it's dirty. */
+        State getState (const AudioProcessorGraph::Node::Ptr&);
+
+        /** A 64-bit FNV-1a hash of a state's bytes. */
+        [[nodiscard]] static uint64 hashState (const MemoryBlock&) noexcept;
+
+        void markDirty (AudioProcessorGraph::NodeID);
+        void markAllDirty();
+
+        /** Forgets the nodes that are no longer part of the graph. */
+        void removeStale (const AudioProcessorGraph&);
+        void clear();
+
+        [[nodiscard]] StateCacheStatistics getStatistics() const;
+
+    private:
+        //==============================================================================
+        struct Entry final : private AudioProcessorListener
+        {
+            explicit Entry (AudioProcessorGraph::Node::Ptr);
+            ~Entry() override;
+
+            void audioProcessorParameterChanged (AudioProcessor*, int, float) override;
+            void audioProcessorChanged (AudioProcessor*, const ChangeDetails&) override;
+
+            const AudioProcessorGraph::Node::Ptr node;
+            State state;
+
+            // set by parameter changes, which can arrive on any thread
+            std::atomic<bool> dirty { true };
+        };
+
+        CriticalSection lock;
+        std::unordered_map<uint32, std::unique_ptr<Entry>> entries;
+        StateCacheStatistics statistics;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NodeStateCache)
+    };
+} // namespace PlayfulTones
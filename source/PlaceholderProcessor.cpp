@@ -0,0 +1,51 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+namespace PlayfulTones {
+    PlaceholderProcessor::PlaceholderProcessor (ProcessorGraph::SavedNode s)
+        : AudioProcessor (createBuses (s)), saved (std::move (s))
+    {
+    }
+
+    AudioProcessor::BusesProperties PlaceholderProcessor::createBuses (const ProcessorGraph::SavedNode& saved)
+    {
+        BusesProperties buses;
+
+        for (auto isInput : { true, false })
+        {
+            const auto& layouts = isInput ? saved.inputBuses : saved.outputBuses;
+
+            for (size_t i = 0; i < layouts.size(); ++i)
+            {
+                const auto busName = (isInput ? "Input " : "Output ") + String ((int) i + 1);
+                const auto set = layouts[i] == ProcessorGraph::disabledAttrValue ? AudioChannelSet::disabled()
+                                                                                 : AudioChannelSet::fromAbbreviatedString (layouts[i]);
+
+                if (set.size() > 0)
+                    buses.addBus (isInput, busName, set, true);
+                else
+                    buses.addBus (isInput, busName, AudioChannelSet::stereo(), false);
+            }
+        }
+
+        return buses;
+    }
+
+    void PlaceholderProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi)
+    {
+        buffer.clear();
+        midi.clear();
+    }
+
+    void PlaceholderProcessor::getStateInformation (MemoryBlock& destData)
+    {
+        if (saved.state != nullptr)
+            destData = saved.state->getData();
+    }
+
+    void PlaceholderProcessor::setStateInformation (const void* data, int sizeInBytes)
+    {
+        saved.state = std::make_shared<const ProcessorGraph::SavedState> (MemoryBlock (data, (size_t) sizeInBytes));
+    }
+} // namespace PlayfulTones
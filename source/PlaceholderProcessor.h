@@ -0,0 +1,65 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /**
+        Stands in for a restored node's processor until it's needed, when lazy instantiation
+        is enabled on the ProcessorGraph.
+
+        It has the saved node's buses and, once ProcessorGraph has looked the module up, its
+        MIDI capabilities, so the node's connections stay valid. It outputs silence. It saves the state it was restored with, so a graph can be saved again
+        without the real processor ever being created.
+    */
+    class PlaceholderProcessor final : public AudioProcessor
+    {
+    public:
+        explicit PlaceholderProcessor (ProcessorGraph::SavedNode);
+
+        [[nodiscard]] const ProcessorGraph::SavedNode& getSavedNode() const noexcept    { return saved; }
+        void setDisplayName (const String& newName)                                      { name = newName; }
+
+        /** Takes the MIDI capabilities of the processor this stands in for. */
+        void setMidiCapabilities (bool accepts, bool produces)                           { midiIn = accepts; midiOut = produces; }
+
+        //==============================================================================
+        const String getName() const override                           { return name; }
+        void prepareToPlay (double, int) override                       {}
+        void releaseResources() override                                {}
+        void processBlock (AudioBuffer<float>&, MidiBuffer&) override;
+        using AudioProcessor::processBlock;
+
+        double getTailLengthSeconds() const override                    { return 0.0; }
+
+        bool acceptsMidi() const override                               { return midiIn; }
+        bool producesMidi() const override                              { return midiOut; }
+
+        bool hasEditor() const override                                 { return false; }
+        AudioProcessorEditor* createEditor() override                   { return nullptr; }
+
+        int getNumPrograms() override                                   { return 1; }
+        int getCurrentProgram() override                                { return 0; }
+        void setCurrentProgram (int) override                           {}
+        const String getProgramName (int) override                      { return {}; }
+        void changeProgramName (int, const String&) override            {}
+
+        void getStateInformation (MemoryBlock&) override;
+        void setStateInformation (const void* data, int sizeInBytes) override;
+
+        bool isBusesLayoutSupported (const BusesLayout&) const override { return true; }
+
+    private:
+        static BusesProperties createBuses (const ProcessorGraph::SavedNode&);
+
+        ProcessorGraph::SavedNode saved;
+        String name { "Not loaded" };
+
+        // until the module is described, MIDI connections made to the real processor must survive the restore
+        bool midiIn = true, midiOut = true;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaceholderProcessor)
+    };
+} // namespace PlayfulTones
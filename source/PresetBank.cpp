@@ -0,0 +1,254 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+namespace PlayfulTones {
+    /*  Preset bank format, all integers little-endian:
+
+        int32       magic ("PTPB")
+        int32       format version
+        int32       preset count
+        index       per preset: int64 data offset from the start of the file, int64 data size
+        names       per preset: string
+        data        the presets' saved graphs, back to back
+    */
+    bool PresetBank::writeToFile (const File& file, const std::vector<Preset>& presets)
+    {
+        MemoryOutputStream names;
+        for (const auto& preset : presets)
+            names.writeString (preset.name);
+
+        const auto indexSize = presets.size() * 2 * sizeof (int64);
+        auto offset = (int64) (3 * sizeof (int) + indexSize + names.getDataSize());
+
+        MemoryOutputStream out;
+        out.writeInt (magic);
+        out.writeInt (formatVersion);
+        out.writeInt ((int) presets.size());
+
+        for (const auto& preset : presets)
+        {
+            out.writeInt64 (offset);
+            out.writeInt64 ((int64) preset.data.getSize());
+            offset += (int64) preset.data.getSize();
+        }
+
+        out.write (names.getData(), names.getDataSize());
+
+        for (const auto& preset : presets)
+            out.write (preset.data.getData(), preset.data.getSize());
+
+        return file.replaceWithData (out.getData(), out.getDataSize());
+    }
+
+    //==============================================================================
+    PresetBank::PresetBank (ProcessorGraph& g, const File& f, int numToPrefetch)
+        : graph (g), numPresetsToPrefetch (jmax (0, numToPrefetch))
+    {
+        file = std::make_unique<MemoryMappedFile> (f, MemoryMappedFile::readOnly);
+
+        if (file->getData() == nullptr)
+            return;
+
+        const auto fileSize = (int64) file->getSize();
+        MemoryInputStream in (file->getData(), file->getSize(), false);
+
+        if (in.readInt() != magic || in.readInt() != formatVersion)
+            return;
+
+        const auto numPresets = in.readInt();
+        if (numPresets < 0 || (int64) numPresets * 2 * (int64) sizeof (int64) > in.getNumBytesRemaining())
+            return;
+
+        std::vector<Entry> index ((size_t) numPresets);
+
+        for (auto& entry : index)
+        {
+            const auto offset = in.readInt64();
+            const auto size = in.readInt64();
+
+            if (offset < 0 || size < 0 || offset > fileSize || size > fileSize - offset)
+                return;
+
+            entry.data = addBytesToPointer (file->getData(), offset);
+            entry.size = (size_t) size;
+        }
+
+        for (auto& entry : index)
+        {
+            if (in.isExhausted())
+                return;
+
+            entry.name = in.readString();
+        }
+
+        entries = std::move (index);
+        builder = std::make_unique<GraphBuildThread> ("ProcessorGraph preset bank", [this] { return takeNextBuild(); },
+                                                      Thread::Priority::low);
+    }
+
+    PresetBank::~PresetBank()
+    {
+        builder = nullptr;
+    }
+
+    String PresetBank::getName (int index) const
+    {
+        return isPositiveAndBelow (index, getNumPresets()) ? entries[(size_t) index].name : String();
+    }
+
+    MemoryBlock PresetBank::getData (int index) const
+    {
+        if (! isPositiveAndBelow (index, getNumPresets()))
+            return {};
+
+        const auto& entry = entries[(size_t) index];
+        return { entry.data, entry.size };
+    }
+
+    //==============================================================================
+    bool PresetBank::switchTo (int index, double crossfadeSeconds)
+    {
+        if (! isPositiveAndBelow (index, getNumPresets()))
+            return false;
+
+        std::optional<ProcessorGraph::PreparedGraph> preset;
+        auto wasPrefetched = false;
+
+        {
+            const ScopedLock sl (lock);
+
+            if (auto it = prepared.find (index); it != prepared.end())
+            {
+                preset = std::move (it->second);
+                prepared.erase (it);
+                wasPrefetched = true;
+            }
+            else
+            {
+                // a prefetch that's still building gives up at its next node, and is discarded
+                wanted.erase (std::remove (wanted.begin(), wanted.end(), index), wanted.end());
+            }
+        }
+
+        if (! wasPrefetched)
+            preset = build (index, nullptr);
+
+        if (! preset.has_value())
+            return false;
+
+        graph.installPreparedGraph (*preset, crossfadeSeconds);
+        currentIndex = index;
+
+        std::vector<int> next;
+        for (int i = 1; i <= numPresetsToPrefetch && i < getNumPresets(); ++i)
+            next.push_back ((index + i) % getNumPresets());
+
+        updateWanted (std::move (next));
+        return true;
+    }
+
+    void PresetBank::prefetch (int index)
+    {
+        if (! isPositiveAndBelow (index, getNumPresets()) || index == currentIndex)
+            return;
+
+        std::vector<int> newWanted;
+
+        {
+            const ScopedLock sl (lock);
+
+            if (std::find (wanted.begin(), wanted.end(), index) != wanted.end())
+                return;
+
+            newWanted = wanted;
+        }
+
+        newWanted.insert (newWanted.begin(), index);
+        updateWanted (std::move (newWanted));
+    }
+
+    bool PresetBank::isPrefetched (int index) const
+    {
+        const ScopedLock sl (lock);
+        const auto it = prepared.find (index);
+        return it != prepared.end() && it->second.has_value();
+    }
+
+    void PresetBank::updateWanted (std::vector<int> newWanted)
+    {
+        std::vector<std::optional<ProcessorGraph::PreparedGraph>> evicted;
+
+        {
+            const ScopedLock sl (lock);
+            wanted = std::move (newWanted);
+
+            for (auto it = prepared.begin(); it != prepared.end();)
+            {
+                if (std::find (wanted.begin(), wanted.end(), it->first) == wanted.end())
+                {
+                    evicted.push_back (std::move (it->second));
+                    it = prepared.erase (it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        // the evicted processors are deleted here, outside the lock
+        if (builder != nullptr)
+            builder->notify();
+    }
+
+    //==============================================================================
+    std::optional<ProcessorGraph::PreparedGraph> PresetBank::build (int index, const std::function<bool()>& shouldAbort)
+    {
+        const auto& entry = entries[(size_t) index];
+        auto saved = ProcessorGraph::readSavedGraph (entry.data, entry.size);
+
+        if (! saved.has_value())
+            return std::nullopt;
+
+        return graph.createPreparedGraph (std::move (*saved), shouldAbort);
+    }
+
+    GraphBuildThread::Build PresetBank::takeNextBuild()
+    {
+        auto index = -1;
+
+        {
+            const ScopedLock sl (lock);
+
+            for (auto i : wanted)
+            {
+                if (prepared.find (i) == prepared.end())
+                {
+                    index = i;
+                    break;
+                }
+            }
+        }
+
+        if (index < 0)
+            return {};
+
+        return [this, index] (const std::function<bool()>& shouldExit)
+        {
+            auto aborted = false;
+            auto result = build (index, [this, index, &aborted, &shouldExit]
+            {
+                const ScopedLock sl (lock);
+                aborted = shouldExit() || std::find (wanted.begin(), wanted.end(), index) == wanted.end();
+                return aborted;
+            });
+
+            const ScopedLock sl (lock);
+
+            // an unreadable preset is kept as nullopt, so it isn't read over and over
+            if (! aborted && std::find (wanted.begin(), wanted.end(), index) != wanted.end())
+                prepared.emplace (index, std::move (result));
+        };
+    }
+} // namespace PlayfulTones
@@ -0,0 +1,99 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /**
+        A file of saved graphs that a ProcessorGraph can switch between quickly.
+
+        The file is memory-mapped and starts with an index, so a preset is read without
+        touching the others. After every switch, the presets that follow the current one
+        are read and their processors built and prepared on a background thread, so that
+        switching to one of them only costs the swap itself.
+
+        The bank must be deleted before the graph it switches.
+    */
+    class PresetBank final
+    {
+    public:
+        /** A preset to be written to a bank, saved with ProcessorGraph::createBinary() or
+            ProcessorGraph::createXmlData().
+        */
+        struct Preset
+        {
+            String name;
+            MemoryBlock data;
+        };
+
+        /** Writes a bank file, replacing the file if it exists. */
+        static bool writeToFile (const File&, const std::vector<Preset>&);
+
+        //==============================================================================
+        /** Opens a bank file. numPresetsToPrefetch is the number of presets after the current
+            one that are kept ready to be switched to.
+        */
+        PresetBank (ProcessorGraph&, const File&, int numPresetsToPrefetch = 2);
+        ~PresetBank();
+
+        /** Returns false if the file couldn't be mapped or isn't a bank. */
+        [[nodiscard]] bool isValid() const noexcept            { return ! entries.empty(); }
+
+        [[nodiscard]] int getNumPresets() const noexcept       { return (int) entries.size(); }
+        [[nodiscard]] String getName (int index) const;
+
+        /** Returns the saved data of a preset, straight from the mapped file. */
+        [[nodiscard]] MemoryBlock getData (int index) const;
+
+        //==============================================================================
+        /** Replaces the graph with a preset. Uses the prefetched processors if they're ready;
+            otherwise cancels any prefetch of the preset and builds its processors on the
+            calling thread. Returns false if the preset can't be read.
+            Must be called on the message thread.
+        */
+        bool switchTo (int index, double crossfadeSeconds = 0.0);
+
+        [[nodiscard]] int getCurrentIndex() const noexcept     { return currentIndex; }
+
+        /** Asks for a preset to be prepared as well as the ones after the current one,
+            e.g. when the user hovers over it.
+        */
+        void prefetch (int index);
+
+        /** Returns true if a preset's processors are ready to be swapped in. */
+        [[nodiscard]] bool isPrefetched (int index) const;
+
+        static constexpr int magic = 0x42505450; // "PTPB"
+        static constexpr int formatVersion = 1;
+
+    private:
+        //==============================================================================
+        struct Entry
+        {
+            String name;
+            const void* data = nullptr;
+            size_t size = 0;
+        };
+
+        GraphBuildThread::Build takeNextBuild();
+        void updateWanted (std::vector<int> newWanted);
+        std::optional<ProcessorGraph::PreparedGraph> build (int index, const std::function<bool()>& shouldAbort);
+
+        ProcessorGraph& graph;
+        std::unique_ptr<MemoryMappedFile> file;
+        std::vector<Entry> entries;
+        const int numPresetsToPrefetch;
+        int currentIndex = -1;
+
+        // the presets to keep ready, most likely first
+        CriticalSection lock;
+        std::vector<int> wanted;
+        std::map<int, std::optional<ProcessorGraph::PreparedGraph>> prepared;
+
+        std::unique_ptr<GraphBuildThread> builder;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+    };
+} // namespace PlayfulTones
@@ -3,22 +3,226 @@
 //
 
 namespace PlayfulTones {
-    ProcessorGraph::ProcessorGraph (ModuleFactory f, GuiConfig guiC)
-        : factory (std::move(f)), guiConfig(guiC)
+    ProcessorGraph::ProcessorGraph (ModuleFactory f, GuiConfig guiC, RenderConfig renderC)
+        : factory (std::move(f)), guiConfig(guiC), renderConfig(renderC)
     {
+        if (renderConfig.enableParallelRendering || renderConfig.enableSilenceSleeping)
+            renderEngine = std::make_unique<RenderEngine> (graph, renderConfig, connectionGains);
+
+        graph.addChangeListener (this);
     }
 
     ProcessorGraph::~ProcessorGraph()
     {
+        loader = nullptr;
+        restorePool = nullptr;
+        graph.removeChangeListener (this);
+        renderEngine = nullptr;
         clear();
     }
 
+    //==============================================================================
+    void ProcessorGraph::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+    {
+        if (renderEngine != nullptr)
+        {
+            renderEngine->prepareToPlay (sampleRate, maximumExpectedSamplesPerBlock);
+            preparedSampleRate = sampleRate;
+            preparedBlockSize = maximumExpectedSamplesPerBlock;
+        }
+        else
+        {
+            graph.prepareToPlay (sampleRate, maximumExpectedSamplesPerBlock);
+        }
+    }
+
+    void ProcessorGraph::releaseResources()
+    {
+        preparedSampleRate = 0.0;
+        preparedBlockSize = 0;
+
+        if (renderEngine != nullptr)
+            renderEngine->releaseResources();
+        else
+            graph.releaseResources();
+    }
+
+    void ProcessorGraph::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi)
+    {
+        if (renderEngine != nullptr)
+            renderEngine->processBlock (buffer, midi);
+        else
+            graph.processBlock (buffer, midi);
+    }
+
+    int ProcessorGraph::getNumRenderThreads() const
+    {
+        return renderEngine != nullptr ? renderEngine->getNumWorkerThreads() : 0;
+    }
+
+    std::optional<NodeTiming> ProcessorGraph::getNodeTiming (NodeID nodeID) const
+    {
+       #if PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING
+        return renderEngine != nullptr ? renderEngine->getNodeTiming (nodeID) : std::nullopt;
+       #else
+        // the engine keeps an entry per node either way, but never times anything
+        ignoreUnused (nodeID);
+        return std::nullopt;
+       #endif
+    }
+
+    std::optional<NodeSleepState> ProcessorGraph::getNodeSleepState (NodeID nodeID) const
+    {
+        return renderEngine != nullptr && renderConfig.enableSilenceSleeping ? renderEngine->getNodeSleepState (nodeID)
+                                                                              : std::nullopt;
+    }
+
+    std::optional<RenderPlanDiagnostics> ProcessorGraph::getRenderPlanDiagnostics() const
+    {
+        return renderEngine != nullptr ? std::make_optional (renderEngine->getPlanDiagnostics())
+                                       : std::nullopt;
+    }
+
+    void ProcessorGraph::setNodeBypassed (NodeID nodeID, bool shouldBeBypassed)
+    {
+        if (auto* node = graph.getNodeForId (nodeID))
+        {
+            node->setBypassed (shouldBeBypassed);
+            topologyChanged();
+        }
+    }
+
+    void ProcessorGraph::setConnectionGain (const AudioProcessorGraph::Connection& connection, float gain)
+    {
+        if (graph.isConnected (connection) && connectionGains.set (connection, gain))
+            topologyChanged();
+    }
+
+    float ProcessorGraph::getConnectionGain (const AudioProcessorGraph::Connection& connection) const
+    {
+        return connectionGains.get (connection);
+    }
+
+    void ProcessorGraph::resetNodeStatistics()
+    {
+        if (renderEngine != nullptr)
+            renderEngine->resetNodeStatistics();
+    }
+
+    void ProcessorGraph::changeListenerCallback (ChangeBroadcaster*)
+    {
+        // catches edits that were made on the AudioProcessorGraph directly
+        connectionGains.removeStale (graph);
+        topologyChanged();
+        stateCache.removeStale (graph);
+        instantiateReachablePlaceholders();
+    }
+
+    void ProcessorGraph::topologyChanged()
+    {
+        if (renderEngine != nullptr && ! isInTransaction())
+            renderEngine->topologyChanged();
+    }
+
+    AudioProcessorGraph::UpdateKind ProcessorGraph::getUpdateKind() const
+    {
+        // the render engine compiles its own plans, so AudioProcessorGraph mustn't rebuild on every edit,
+        // and inside a transaction the rebuild happens once on commit
+        return renderEngine != nullptr || isInTransaction() ? AudioProcessorGraph::UpdateKind::none
+                                                            : AudioProcessorGraph::UpdateKind::sync;
+    }
+
+    //==============================================================================
+    void ProcessorGraph::beginTransaction()
+    {
+        ++transactionDepth;
+    }
+
+    void ProcessorGraph::commit()
+    {
+        jassert (transactionDepth > 0);
+
+        if (--transactionDepth > 0)
+            return;
+
+        if (renderEngine == nullptr)
+            graph.rebuild();
+
+        topologyChanged();
+
+        const auto changes = std::exchange (pendingChanges, {});
+
+        if (! changes.isEmpty())
+            graphListeners.call(&Listener::changesCommitted, changes);
+
+        if (! changes.connectionsAdded.empty())
+            instantiateReachablePlaceholders();
+    }
+
+    // A removal cancels an addition made earlier in the same transaction, so that the ChangeSet
+    // only holds net changes. An addition is always recorded: if the item was removed earlier it
+    // existed before the transaction, and listeners see it removed and then added.
+    template <typename Item>
+    static void recordRemoval (std::vector<Item>& added, std::vector<Item>& removed, const Item& item)
+    {
+        if (const auto it = std::find (added.begin(), added.end(), item); it != added.end())
+            added.erase (it);
+        else
+            removed.push_back (item);
+    }
+
+    void ProcessorGraph::notifyNodeAdded (NodeID nodeID)
+    {
+        if (isInTransaction())
+            pendingChanges.nodesAdded.push_back (nodeID);
+        else
+            graphListeners.call(&Listener::nodeAdded, nodeID);
+    }
+
+    void ProcessorGraph::notifyNodeRemoved (NodeID nodeID)
+    {
+        if (isInTransaction())
+        {
+            // the graph drops the node's connections without reporting them
+            auto& connections = pendingChanges.connectionsAdded;
+            connections.erase (std::remove_if (connections.begin(), connections.end(), [nodeID] (const auto& c)
+                                               {
+                                                   return c.source.nodeID == nodeID || c.destination.nodeID == nodeID;
+                                               }),
+                               connections.end());
+
+            recordRemoval (pendingChanges.nodesAdded, pendingChanges.nodesRemoved, nodeID);
+        }
+        else
+            graphListeners.call(&Listener::nodeRemoved, nodeID);
+    }
+
+    void ProcessorGraph::notifyConnectionAdded (const AudioProcessorGraph::Connection& connection)
+    {
+        if (isInTransaction())
+            pendingChanges.connectionsAdded.push_back (connection);
+        else
+            graphListeners.call(&Listener::connectionAdded, connection);
+    }
+
+    void ProcessorGraph::notifyConnectionRemoved (const AudioProcessorGraph::Connection& connection)
+    {
+        if (isInTransaction())
+            recordRemoval (pendingChanges.connectionsAdded, pendingChanges.connectionsRemoved, connection);
+        else
+            graphListeners.call(&Listener::connectionRemoved, connection);
+    }
+
     void ProcessorGraph::setNodePosition (NodeID nodeID, Point<double> pos) const
     {
         if (auto* n = graph.getNodeForId (nodeID))
         {
-            n->properties.set (xPosId, jlimit (0.0, 1.0, pos.x));
-            n->properties.set (yPosId, jlimit (0.0, 1.0, pos.y));
+            // a zoomable canvas extends beyond the unit square
+            if (! guiConfig.useZoomableCanvas)
+                pos = { jlimit (0.0, 1.0, pos.x), jlimit (0.0, 1.0, pos.y) };
+
+            n->properties.set (xPosId, pos.x);
+            n->properties.set (yPosId, pos.y);
         }
     }
 
@@ -34,43 +238,40 @@ namespace PlayfulTones {
     //==============================================================================
     void ProcessorGraph::clear()
     {
+        const ScopedTransaction transaction (*this);
         graphListeners.call(&Listener::graphIsAboutToBeCleared);
-        graph.clear();
+        stateCache.clear();
+        graph.clear (getUpdateKind());
         factoryIdToNextInstanceIdMap.clear();
     }
 
     //==============================================================================
-    static void readBusLayoutFromXml (AudioProcessor::BusesLayout& busesLayout, AudioProcessor& plugin,
-                                      const XmlElement& xml, bool isInput)
+    /** Applies saved bus layouts, indexed by bus. An empty entry keeps the bus's current layout. */
+    static void applyBusLayout (AudioProcessor::BusesLayout& busesLayout, AudioProcessor& plugin,
+                                const std::vector<String>& savedBuses, bool isInput)
     {
         auto& targetBuses = (isInput ? busesLayout.inputBuses
                                      : busesLayout.outputBuses);
-        int maxNumBuses = 0;
+        const int maxNumBuses = (int) savedBuses.size();
 
-        if (auto* buses = xml.getChildByName (isInput ? ProcessorGraph::inputsAttrName : ProcessorGraph::outputsAttrName))
+        for (int busIdx = 0; busIdx < maxNumBuses; ++busIdx)
         {
-            for (auto* e : buses->getChildWithTagNameIterator (ProcessorGraph::busAttrName))
-            {
-                const int busIdx = e->getIntAttribute (ProcessorGraph::indexAttrName);
-                maxNumBuses = jmax (maxNumBuses, busIdx + 1);
-
-                // the number of buses on busesLayout may not be in sync with the plugin after adding buses
-                // because adding an input bus could also add an output bus
-                for (int actualIdx = plugin.getBusCount (isInput) - 1; actualIdx < busIdx; ++actualIdx)
-                    if (! plugin.addBus (isInput))
-                        return;
+            // the number of buses on busesLayout may not be in sync with the plugin after adding buses
+            // because adding an input bus could also add an output bus
+            for (int actualIdx = plugin.getBusCount (isInput) - 1; actualIdx < busIdx; ++actualIdx)
+                if (! plugin.addBus (isInput))
+                    return;
 
-                for (int actualIdx = targetBuses.size() - 1; actualIdx < busIdx; ++actualIdx)
-                    targetBuses.add (plugin.getChannelLayoutOfBus (isInput, busIdx));
+            for (int actualIdx = targetBuses.size() - 1; actualIdx < busIdx; ++actualIdx)
+                targetBuses.add (plugin.getChannelLayoutOfBus (isInput, busIdx));
 
-                auto layout = e->getStringAttribute (ProcessorGraph::layoutAttrName);
+            const auto& layout = savedBuses[(size_t) busIdx];
 
-                if (layout.isNotEmpty())
-                    targetBuses.getReference (busIdx) = AudioChannelSet::fromAbbreviatedString (layout);
-            }
+            if (layout.isNotEmpty())
+                targetBuses.getReference (busIdx) = AudioChannelSet::fromAbbreviatedString (layout);
         }
 
-        // if the plugin has more buses than specified in the xml, then try to remove them!
+        // if the plugin has more buses than were saved, then try to remove them!
         while (maxNumBuses < targetBuses.size())
         {
             if (! plugin.removeBus (isInput))
@@ -80,27 +281,158 @@ namespace PlayfulTones {
         }
     }
 
-    //==============================================================================
-    static XmlElement* createBusLayoutXml (const AudioProcessor::BusesLayout& layout, const bool isInput)
+    static std::vector<String> getBusLayoutStrings (const AudioProcessor::BusesLayout& layout, bool isInput)
     {
         auto& buses = isInput ? layout.inputBuses
                               : layout.outputBuses;
 
-        auto* xml = new XmlElement (isInput ? ProcessorGraph::inputsAttrName : ProcessorGraph::outputsAttrName);
+        std::vector<String> strings;
+
+        for (auto& set : buses)
+            strings.push_back (set.isDisabled() ? ProcessorGraph::disabledAttrValue : set.getSpeakerArrangementAsString());
+
+        return strings;
+    }
+
+    //==============================================================================
+    static std::vector<String> readBusLayoutFromXml (const XmlElement& xml, bool isInput)
+    {
+        std::vector<String> savedBuses;
 
-        for (int busIdx = 0; busIdx < buses.size(); ++busIdx)
+        if (auto* buses = xml.getChildByName (isInput ? ProcessorGraph::inputsAttrName : ProcessorGraph::outputsAttrName))
         {
-            auto& set = buses.getReference (busIdx);
+            for (auto* e : buses->getChildWithTagNameIterator (ProcessorGraph::busAttrName))
+            {
+                const int busIdx = e->getIntAttribute (ProcessorGraph::indexAttrName);
+
+                if (busIdx < 0)
+                    continue;
+
+                if (busIdx >= (int) savedBuses.size())
+                    savedBuses.resize ((size_t) busIdx + 1);
+
+                savedBuses[(size_t) busIdx] = e->getStringAttribute (ProcessorGraph::layoutAttrName);
+            }
+        }
+
+        return savedBuses;
+    }
+
+    static XmlElement* createBusLayoutXml (const AudioProcessor::BusesLayout& layout, const bool isInput)
+    {
+        auto* xml = new XmlElement (isInput ? ProcessorGraph::inputsAttrName : ProcessorGraph::outputsAttrName);
+        const auto buses = getBusLayoutStrings (layout, isInput);
 
+        for (int busIdx = 0; busIdx < (int) buses.size(); ++busIdx)
+        {
             auto* bus = xml->createNewChildElement (ProcessorGraph::busAttrName);
             bus->setAttribute (ProcessorGraph::indexAttrName, busIdx);
-            bus->setAttribute (ProcessorGraph::layoutAttrName, set.isDisabled() ? ProcessorGraph::disabledAttrValue : set.getSpeakerArrangementAsString());
+            bus->setAttribute (ProcessorGraph::layoutAttrName, buses[(size_t) busIdx]);
         }
 
         return xml;
     }
 
-    static XmlElement* createNodeXml (AudioProcessorGraph::Node* const node) noexcept
+    /** Collects the distinct processor states of a save, so that identical states are stored once. */
+    class StateTable
+    {
+    public:
+        /** Returns the index of the state in the table, adding it if it isn't there yet. */
+        int add (const NodeStateCache::State& state)
+        {
+            const auto [it, isNew] = indices.try_emplace (state.hash, (int) blobs.size());
+
+            // a hash collision between different states just gets a slot of its own
+            if (isNew || *blobs[(size_t) it->second] != *state.data)
+            {
+                blobs.push_back (state.data);
+                useCounts.push_back (1);
+                return (int) blobs.size() - 1;
+            }
+
+            ++useCounts[(size_t) it->second];
+            return it->second;
+        }
+
+        [[nodiscard]] bool isShared (int index) const   { return useCounts[(size_t) index] > 1; }
+
+        std::vector<std::shared_ptr<const MemoryBlock>> blobs;
+        std::vector<int> useCounts;
+
+    private:
+        std::unordered_map<uint64, int> indices;
+    };
+
+    ProcessorGraph::SavedState::SavedState (MemoryBlock d)
+        : data (std::move (d))
+    {
+    }
+
+    ProcessorGraph::SavedState::SavedState (String base64, bool compressed)
+        : encoded (std::move (base64)), isCompressed (compressed)
+    {
+    }
+
+    const MemoryBlock& ProcessorGraph::SavedState::getData() const
+    {
+        std::call_once (decodeFlag, [this]
+        {
+            if (encoded.isEmpty())
+                return;
+
+            data.fromBase64Encoding (encoded);
+
+            if (isCompressed)
+            {
+                GZIPDecompressorInputStream in (new MemoryInputStream (data, true), true,
+                                                GZIPDecompressorInputStream::gzipFormat);
+                MemoryBlock decompressed;
+                in.readIntoMemoryBlock (decompressed);
+                data = std::move (decompressed);
+            }
+        });
+
+        return data;
+    }
+
+    static void writeStateXml (XmlElement& e, const MemoryBlock& state, int compressionThreshold)
+    {
+        if (compressionThreshold >= 0 && state.getSize() >= (size_t) compressionThreshold)
+        {
+            MemoryOutputStream compressed;
+
+            {
+                GZIPCompressorOutputStream gzip (compressed, -1, GZIPCompressorOutputStream::windowBitsGZIP);
+                gzip.write (state.getData(), state.getSize());
+            }
+
+            if (compressed.getDataSize() < state.getSize())
+            {
+                e.setAttribute (ProcessorGraph::codecAttrName, ProcessorGraph::gzipCodec);
+                e.addTextElement (compressed.getMemoryBlock().toBase64Encoding());
+                return;
+            }
+        }
+
+        e.addTextElement (state.toBase64Encoding());
+    }
+
+    static std::shared_ptr<const ProcessorGraph::SavedState> readStateXml (const XmlElement& e)
+    {
+        const auto codec = e.getStringAttribute (ProcessorGraph::codecAttrName);
+
+        if (codec.isNotEmpty() && codec != ProcessorGraph::gzipCodec)
+        {
+            // saved by a newer version, with a codec this one doesn't know
+            jassertfalse;
+            return nullptr;
+        }
+
+        return std::make_shared<const ProcessorGraph::SavedState> (e.getAllSubText(), codec.isNotEmpty());
+    }
+
+    static XmlElement* createNodeXml (AudioProcessorGraph::Node* const node, const StateTable& states, int stateIndex,
+                                      int compressionThreshold) noexcept
     {
         auto* processor = node->getProcessor();
         auto e = new XmlElement (ProcessorGraph::filterAttrName);
@@ -148,9 +480,12 @@ namespace PlayfulTones {
             }
         }
 
-        MemoryBlock m;
-        node->getProcessor()->getStateInformation (m);
-        e->createNewChildElement (ProcessorGraph::stateAttrName)->addTextElement (m.toBase64Encoding());
+        auto* stateElement = e->createNewChildElement (ProcessorGraph::stateAttrName);
+
+        if (states.isShared (stateIndex))
+            stateElement->setAttribute (ProcessorGraph::stateRefAttrName, stateIndex);
+        else
+            writeStateXml (*stateElement, *states.blobs[(size_t) stateIndex], compressionThreshold);
 
         auto layout = processor->getBusesLayout();
         auto layouts = e->createNewChildElement (ProcessorGraph::layoutAttrName);
@@ -160,178 +495,949 @@ namespace PlayfulTones {
         return e;
     }
 
-    AudioProcessorGraph::Node::Ptr ProcessorGraph::createNodeFromXml(const XmlElement& xml)
+    using SharedStates = std::unordered_map<int, std::shared_ptr<const ProcessorGraph::SavedState>>;
+
+    static std::optional<ProcessorGraph::SavedNode> readNodeFromXml (const XmlElement& xml, const SharedStates& sharedStates)
     {
         const auto properties = xml.getChildWithTagNameIterator(ProcessorGraph::propertyAttrName);
 
         if (properties == nullptr)
-            return nullptr;
+            return std::nullopt;
 
+        ProcessorGraph::SavedNode saved;
         auto uid = -1;
-        auto factoryIndex = -1;
+
         for(auto* propElement : properties)
         {
             auto name = propElement->getStringAttribute(ProcessorGraph::nameTag);
+            auto type = propElement->getStringAttribute(ProcessorGraph::typeTag);
+            auto var = juce::var();
+            if(type == ProcessorGraph::intValue)
+                var = propElement->getIntAttribute(ProcessorGraph::valueTag);
+            else if(type == ProcessorGraph::floatValue)
+                var = propElement->getDoubleAttribute(ProcessorGraph::valueTag);
+            else if(type == ProcessorGraph::stringValue)
+                var = propElement->getStringAttribute(ProcessorGraph::valueTag);
+            else if(type == ProcessorGraph::boolValue)
+                var = propElement->getBoolAttribute(ProcessorGraph::valueTag);
+            saved.properties.set(name, var);
+
             if(name == ProcessorGraph::nodeId)
                 uid = static_cast<int>(propElement->getIntAttribute(ProcessorGraph::valueTag));
             else if(name == ProcessorGraph::factoryId)
-                factoryIndex = propElement->getIntAttribute(ProcessorGraph::valueTag);
+                saved.factoryIndex = propElement->getIntAttribute(ProcessorGraph::valueTag);
         }
 
-        if(uid == -1 || factoryIndex == -1)
-            return nullptr;
+        if(uid == -1 || saved.factoryIndex == -1)
+            return std::nullopt;
+
+        saved.nodeID = ProcessorGraph::NodeID(static_cast<uint32>(uid));
+
+        for (int i = (int)ModuleWindow::Type::first; i <= (int)ModuleWindow::Type::last; ++i)
+        {
+            auto type = (ModuleWindow::Type) i;
+
+            if (xml.hasAttribute (ModuleWindow::getOpenProp (type)))
+            {
+                saved.properties.set (ModuleWindow::getLastXProp (type), xml.getIntAttribute (ModuleWindow::getLastXProp (type)));
+                saved.properties.set (ModuleWindow::getLastYProp (type), xml.getIntAttribute (ModuleWindow::getLastYProp (type)));
+                saved.properties.set (ModuleWindow::getOpenProp  (type), xml.getIntAttribute (ModuleWindow::getOpenProp (type)));
+            }
+        }
+
+        if (auto* layoutElement = xml.getChildByName(ProcessorGraph::layoutAttrName))
+        {
+            saved.hasLayout = true;
+            saved.inputBuses = readBusLayoutFromXml(*layoutElement, true);
+            saved.outputBuses = readBusLayoutFromXml(*layoutElement, false);
+        }
+
+        if (auto* stateElement = xml.getChildByName(ProcessorGraph::stateAttrName))
+        {
+            if (stateElement->hasAttribute(ProcessorGraph::stateRefAttrName))
+            {
+                const auto it = sharedStates.find(stateElement->getIntAttribute(ProcessorGraph::stateRefAttrName));
+                if (it != sharedStates.end())
+                    saved.state = it->second;
+            }
+            else
+            {
+                saved.state = readStateXml(*stateElement);
+            }
+        }
+
+        return saved;
+    }
 
-        auto processor = factory.createProcessor(factoryIndex);
+    std::unique_ptr<AudioProcessor> ProcessorGraph::createProcessorFromSavedNode(const SavedNode& saved)
+    {
+        auto processor = factory.createProcessor(saved.factoryIndex);
 
         if (processor == nullptr)
             return nullptr;
 
         AudioProcessor::BusesLayout layout = processor->getBusesLayout();
 
-        if (auto* layoutElement = xml.getChildByName(ProcessorGraph::layoutAttrName))
+        if (saved.hasLayout)
         {
-            readBusLayoutFromXml(layout, *processor, *layoutElement, true);
-            readBusLayoutFromXml(layout, *processor, *layoutElement, false);
+            applyBusLayout(layout, *processor, saved.inputBuses, true);
+            applyBusLayout(layout, *processor, saved.outputBuses, false);
         }
 
         processor->setBusesLayout(layout);
 
-        if (auto* stateElement = xml.getChildByName(ProcessorGraph::stateAttrName))
+        if (saved.state != nullptr)
         {
-            MemoryBlock state;
-            state.fromBase64Encoding(stateElement->getAllSubText());
+            const auto& state = saved.state->getData();
             processor->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
         }
 
-        if (auto node = graph.addNode(std::move(processor), NodeID(static_cast<uint32>(uid))))
-        {
-            for(auto* propElement : properties)
+        return processor;
+    }
+
+    AudioProcessorGraph::Node::Ptr ProcessorGraph::addSavedNode(const SavedNode& saved, std::unique_ptr<AudioProcessor> processor)
+    {
+        if (processor == nullptr)
+            return nullptr;
+
+        if (auto* placeholder = dynamic_cast<PlaceholderProcessor*>(processor.get()))
+            if (const auto* descriptor = factory.getDescriptor(saved.factoryIndex))
             {
-                auto name = propElement->getStringAttribute(ProcessorGraph::nameTag);
-                auto type = propElement->getStringAttribute(ProcessorGraph::typeTag);
-                auto var = juce::var();
-                if(type == ProcessorGraph::intValue)
-                    var = propElement->getIntAttribute(ProcessorGraph::valueTag);
-                else if(type == ProcessorGraph::floatValue)
-                    var = propElement->getDoubleAttribute(ProcessorGraph::valueTag);
-                else if(type == ProcessorGraph::stringValue)
-                    var = propElement->getStringAttribute(ProcessorGraph::valueTag);
-                else if(type == ProcessorGraph::boolValue)
-                    var = propElement->getBoolAttribute(ProcessorGraph::valueTag);
-                node->properties.set(name, var);
+                placeholder->setDisplayName(descriptor->name);
+                placeholder->setMidiCapabilities(descriptor->acceptsMidi, descriptor->producesMidi);
             }
 
+        if (auto node = graph.addNode(std::move(processor), saved.nodeID, getUpdateKind()))
+        {
+            for (const auto& prop : saved.properties)
+                node->properties.set(prop.name, prop.value);
+
             for (int i = (int)ModuleWindow::Type::first; i <= (int)ModuleWindow::Type::last; ++i)
             {
                 auto type = (ModuleWindow::Type) i;
 
-                if (xml.hasAttribute (ModuleWindow::getOpenProp (type)))
+                if (node->properties.contains (ModuleWindow::getOpenProp (type)) && node->properties[ModuleWindow::getOpenProp (type)])
                 {
-                    node->properties.set (ModuleWindow::getLastXProp (type), xml.getIntAttribute (ModuleWindow::getLastXProp (type)));
-                    node->properties.set (ModuleWindow::getLastYProp (type), xml.getIntAttribute (ModuleWindow::getLastYProp (type)));
-                    node->properties.set (ModuleWindow::getOpenProp  (type), xml.getIntAttribute (ModuleWindow::getOpenProp (type)));
-
-                    if (node->properties[ModuleWindow::getOpenProp (type)])
-                    {
-                        jassert (node->getProcessor() != nullptr);
-
-                        if(onProcessorWindowRequested != nullptr)
-                            if(auto* w = onProcessorWindowRequested(node, type))
-                                w->toFront (true);
-                    }
+                    jassert (node->getProcessor() != nullptr);
+
+                    if(onProcessorWindowRequested != nullptr)
+                        if(auto* w = onProcessorWindowRequested(node, type))
+                            w->toFront (true);
                 }
             }
 
+            notifyNodeAdded(node->nodeID);
             return node;
         }
 
         return nullptr;
     }
 
-    std::unique_ptr<XmlElement> ProcessorGraph::createXml() const
+    void ProcessorGraph::setNumRestoreThreads (int numThreads)
     {
-        auto xml = std::make_unique<XmlElement> (ProcessorGraph::graphAttrName);
-
-        for (auto* node : graph.getNodes())
-            xml->addChildElement (createNodeXml (node));
-
-        for (auto& connection : graph.getConnections())
-        {
-            auto e = xml->createNewChildElement (ProcessorGraph::connectionAttrName);
+        const ScopedLock sl (restorePoolLock);
+        numRestoreThreads = numThreads;
+        restorePool = nullptr;
+    }
 
-            e->setAttribute (ProcessorGraph::srcFilterAttrName, (int) connection.source.nodeID.uid);
-            e->setAttribute (ProcessorGraph::srcChannelAttrName, connection.source.channelIndex);
-            e->setAttribute (ProcessorGraph::dstFilterAttrName, (int) connection.destination.nodeID.uid);
-            e->setAttribute (ProcessorGraph::dstChannelAttrName, connection.destination.channelIndex);
-        }
+    static bool hasOpenWindow (const NamedValueSet& properties)
+    {
+        for (int i = (int)ModuleWindow::Type::first; i <= (int)ModuleWindow::Type::last; ++i)
+            if (properties[ModuleWindow::getOpenProp ((ModuleWindow::Type) i)])
+                return true;
 
-        return xml;
+        return false;
     }
 
-    void ProcessorGraph::restoreFromXml(const XmlElement& xmlElement)
+    /** Returns which saved nodes can't be heard, because they don't feed any node without audio outputs. */
+    static std::vector<bool> findInaudibleNodes (const ProcessorGraph::SavedGraph& saved)
     {
-        if (!xmlElement.hasTagName(ProcessorGraph::graphAttrName)) return;
+        std::unordered_map<uint32, size_t> indices;
+        for (size_t i = 0; i < saved.nodes.size(); ++i)
+            indices[saved.nodes[i].nodeID.uid] = i;
 
-        restoredState = XmlElement(xmlElement);
+        std::unordered_multimap<uint32, uint32> sourcesOf;
+        for (const auto& c : saved.connections)
+            sourcesOf.emplace (c.destination.nodeID.uid, c.source.nodeID.uid);
 
-        struct ConnectionConfig {
-            int srcFilter;
-            int srcChannel;
-            int dstFilter;
-            int dstChannel;
-        };
+        std::vector<bool> isAudible (saved.nodes.size(), false);
+        std::vector<size_t> toVisit;
 
-        std::vector<ConnectionConfig> restoredConnections;
-        for (auto* connectionElement : restoredState.getChildWithTagNameIterator(ProcessorGraph::connectionAttrName))
+        for (size_t i = 0; i < saved.nodes.size(); ++i)
         {
-            restoredConnections.push_back({
-                connectionElement->getIntAttribute(ProcessorGraph::srcFilterAttrName),
-                connectionElement->getIntAttribute(ProcessorGraph::srcChannelAttrName),
-                connectionElement->getIntAttribute(ProcessorGraph::dstFilterAttrName),
-                connectionElement->getIntAttribute(ProcessorGraph::dstChannelAttrName)
-            });
-        }
+            const auto& node = saved.nodes[i];
+            const auto isSink = std::all_of (node.outputBuses.begin(), node.outputBuses.end(),
+                                             [] (const String& bus) { return bus == ProcessorGraph::disabledAttrValue; });
 
-        clear();
-        for (auto* filterElement : restoredState.getChildWithTagNameIterator(ProcessorGraph::filterAttrName))
-        {
-            auto node = createNodeFromXml(*filterElement);
-            if(node != nullptr)
-                graphListeners.call(&Listener::nodeAdded, node->nodeID);
+            if (! node.hasLayout || isSink || hasOpenWindow (node.properties))
+            {
+                isAudible[i] = true;
+                toVisit.push_back (i);
+            }
         }
-        for (auto& conn : restoredConnections)
+
+        while (! toVisit.empty())
         {
-            const auto connection = AudioProcessorGraph::Connection{
-                {NodeID(static_cast<uint32>(conn.srcFilter)), conn.srcChannel},
-                {NodeID(static_cast<uint32>(conn.dstFilter)), conn.dstChannel}
-            };
-            addConnection(connection);
+            const auto uid = saved.nodes[toVisit.back()].nodeID.uid;
+            toVisit.pop_back();
+
+            const auto [begin, end] = sourcesOf.equal_range (uid);
+            for (auto it = begin; it != end; ++it)
+            {
+                if (const auto source = indices.find (it->second); source != indices.end() && ! isAudible[source->second])
+                {
+                    isAudible[source->second] = true;
+                    toVisit.push_back (source->second);
+                }
+            }
         }
-        graph.removeIllegalConnections();
-    }
 
-    void ProcessorGraph::addConnection (const AudioProcessorGraph::Connection& connection)
-    {
-        graph.addConnection (connection);
-        graphListeners.call(&Listener::connectionAdded, connection);
-    }
+        std::vector<bool> isInaudible;
+        for (auto audible : isAudible)
+            isInaudible.push_back (! audible);
 
-    void ProcessorGraph::removeConnection (const AudioProcessorGraph::Connection& connection)
-    {
-        graph.removeConnection (connection);
-        graphListeners.call(&Listener::connectionRemoved, connection);
+        return isInaudible;
     }
 
-    void ProcessorGraph::removeNode (NodeID nodeID)
+    std::vector<std::unique_ptr<AudioProcessor>> ProcessorGraph::createProcessorsFromSavedGraph(const SavedGraph& saved, double sampleRate, int blockSize,
+                                                                                                 const std::function<bool()>& shouldAbort)
     {
-        if (auto* node = graph.getNodeForId (nodeID))
+        std::vector<std::unique_ptr<AudioProcessor>> processors (saved.nodes.size());
+        std::atomic<size_t> nextNode { 0 };
+
+        const auto isLazy = lazyInstantiation ? findInaudibleNodes(saved)
+                                              : std::vector<bool> (saved.nodes.size(), false);
+
+        // every participant takes the next unbuilt node until none are left
+        const auto buildNodes = [&]
         {
-            graph.removeNode (node);
-            graphListeners.call(&Listener::nodeRemoved, nodeID);
-        }
-    }
+            for (auto i = nextNode++; i < saved.nodes.size(); i = nextNode++)
+            {
+                if (shouldAbort != nullptr && shouldAbort())
+                    return;
 
-    void ProcessorGraph::removeNode (const AudioProcessorGraph::Node::Ptr& node)
+                auto processor = isLazy[i] ? std::make_unique<PlaceholderProcessor>(saved.nodes[i])
+                                           : createProcessorFromSavedNode(saved.nodes[i]);
+
+                if (processor != nullptr && sampleRate > 0.0)
+                {
+                    processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+                    processor->prepareToPlay(sampleRate, blockSize);
+                }
+
+                processors[i] = std::move(processor);
+            }
+        };
+
+        std::shared_ptr<ThreadPool> pool;
+
+        if (saved.nodes.size() > 1)
+        {
+            const ScopedLock sl (restorePoolLock);
+
+            const auto numThreads = numRestoreThreads < 0 ? SystemStats::getNumCpus() - 1 : numRestoreThreads;
+
+            if (restorePool == nullptr && numThreads > 0)
+                restorePool = std::make_shared<ThreadPool>(numThreads);
+
+            pool = restorePool;
+        }
+
+        if (pool == nullptr)
+        {
+            buildNodes();
+            return processors;
+        }
+
+        // the pool is shared with other work such as preset prefetching, so a helper may not start
+        // before the caller has built every node
+        struct Helper final : public ThreadPoolJob
+        {
+            explicit Helper (const std::function<void()>& fn) : ThreadPoolJob ("Restore helper"), build (fn) {}
+
+            JobStatus runJob() override
+            {
+                build();
+                return jobHasFinished;
+            }
+
+            const std::function<void()>& build;
+        };
+
+        const std::function<void()> build = buildNodes;
+        const auto numHelpers = jmin(pool->getNumThreads(), static_cast<int>(saved.nodes.size()) - 1);
+        std::vector<std::unique_ptr<Helper>> helpers;
+
+        for (int i = 0; i < numHelpers; ++i)
+        {
+            helpers.push_back (std::make_unique<Helper> (build));
+            pool->addJob (helpers.back().get(), false);
+        }
+
+        // the calling thread builds nodes too. Once it runs out, the helpers that haven't started are
+        // dropped and only the running ones are waited for, so a busy pool can't stall the restore
+        buildNodes();
+
+        for (auto& helper : helpers)
+            if (! pool->removeJob (helper.get(), false, 0))
+                pool->waitForJobToFinish (helper.get(), -1);
+
+        return processors;
+    }
+
+    void ProcessorGraph::restoreFromSavedGraph(const SavedGraph& saved)
+    {
+        auto processors = createProcessorsFromSavedGraph(saved, 0.0, 0);
+
+        // nodes are inserted and announced in their saved order, whichever thread built them
+        const ScopedTransaction transaction (*this);
+
+        clear();
+        for (size_t i = 0; i < saved.nodes.size(); ++i)
+            addSavedNode(saved.nodes[i], std::move(processors[i]));
+        for (const auto& connection : saved.connections)
+            addConnection(connection);
+        graph.removeIllegalConnections (getUpdateKind());
+    }
+
+    std::unique_ptr<XmlElement> ProcessorGraph::createXml() const
+    {
+        auto xml = std::make_unique<XmlElement> (ProcessorGraph::graphAttrName);
+        const auto nodes = graph.getNodes();
+
+        StateTable states;
+        std::vector<int> stateIndices;
+
+        stateCache.beginSave();
+        for (auto* node : nodes)
+            stateIndices.push_back (states.add (stateCache.getState (node)));
+
+        // states used by more than one node are written once, and referenced by index
+        XmlElement* sharedStates = nullptr;
+        for (size_t i = 0; i < states.blobs.size(); ++i)
+        {
+            if (! states.isShared ((int) i))
+                continue;
+
+            if (sharedStates == nullptr)
+                sharedStates = xml->createNewChildElement (ProcessorGraph::sharedStatesAttrName);
+
+            auto* e = sharedStates->createNewChildElement (ProcessorGraph::stateAttrName);
+            e->setAttribute (ProcessorGraph::indexAttrName, (int) i);
+            writeStateXml (*e, *states.blobs[i], stateCompressionThreshold);
+        }
+
+        for (int i = 0; i < nodes.size(); ++i)
+            xml->addChildElement (createNodeXml (nodes.getObjectPointerUnchecked (i), states, stateIndices[(size_t) i],
+                                                 stateCompressionThreshold));
+
+        for (auto& connection : graph.getConnections())
+        {
+            auto e = xml->createNewChildElement (ProcessorGraph::connectionAttrName);
+
+            e->setAttribute (ProcessorGraph::srcFilterAttrName, (int) connection.source.nodeID.uid);
+            e->setAttribute (ProcessorGraph::srcChannelAttrName, connection.source.channelIndex);
+            e->setAttribute (ProcessorGraph::dstFilterAttrName, (int) connection.destination.nodeID.uid);
+            e->setAttribute (ProcessorGraph::dstChannelAttrName, connection.destination.channelIndex);
+        }
+
+        return xml;
+    }
+
+    void ProcessorGraph::markDirty (NodeID nodeID)
+    {
+        stateCache.markDirty (nodeID);
+    }
+
+    StateCacheStatistics ProcessorGraph::getStateCacheStatistics() const
+    {
+        return stateCache.getStatistics();
+    }
+
+    std::optional<ProcessorGraph::SavedGraph> ProcessorGraph::readXml(const XmlElement& xmlElement)
+    {
+        if (!xmlElement.hasTagName(ProcessorGraph::graphAttrName))
+            return std::nullopt;
+
+        SavedGraph saved;
+
+        for (auto* connectionElement : xmlElement.getChildWithTagNameIterator(ProcessorGraph::connectionAttrName))
+        {
+            saved.connections.push_back({
+                {NodeID(static_cast<uint32>(connectionElement->getIntAttribute(ProcessorGraph::srcFilterAttrName))),
+                 connectionElement->getIntAttribute(ProcessorGraph::srcChannelAttrName)},
+                {NodeID(static_cast<uint32>(connectionElement->getIntAttribute(ProcessorGraph::dstFilterAttrName))),
+                 connectionElement->getIntAttribute(ProcessorGraph::dstChannelAttrName)}
+            });
+        }
+
+        SharedStates sharedStates;
+
+        if (auto* statesElement = xmlElement.getChildByName(ProcessorGraph::sharedStatesAttrName))
+            for (auto* stateElement : statesElement->getChildWithTagNameIterator(ProcessorGraph::stateAttrName))
+                sharedStates[stateElement->getIntAttribute(ProcessorGraph::indexAttrName)] = readStateXml(*stateElement);
+
+        for (auto* filterElement : xmlElement.getChildWithTagNameIterator(ProcessorGraph::filterAttrName))
+            if (auto node = readNodeFromXml(*filterElement, sharedStates))
+                saved.nodes.push_back(std::move(*node));
+
+        return saved;
+    }
+
+    void ProcessorGraph::restoreFromXml(const XmlElement& xmlElement)
+    {
+        if (!xmlElement.hasTagName(ProcessorGraph::graphAttrName)) return;
+
+        restoredState = XmlElement(xmlElement);
+
+        if (auto saved = readXml(restoredState))
+        {
+            cancelPendingLoad();
+            restoreFromSavedGraph(*saved);
+        }
+    }
+
+    MemoryBlock ProcessorGraph::createXmlData (bool compress) const
+    {
+        const auto xml = createXml();
+        MemoryOutputStream out;
+
+        if (compress)
+        {
+            GZIPCompressorOutputStream gzip (out, -1, GZIPCompressorOutputStream::windowBitsGZIP);
+            xml->writeTo (gzip);
+        }
+        else
+        {
+            xml->writeTo (out);
+        }
+
+        return out.getMemoryBlock();
+    }
+
+    /** Parses XML text, which may be GZIP-compressed. */
+    static std::unique_ptr<XmlElement> parseXmlData (const void* data, size_t numBytes)
+    {
+        const auto* bytes = static_cast<const uint8*> (data);
+        const auto isGzip = numBytes >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b;
+
+        MemoryBlock text;
+
+        if (isGzip)
+        {
+            GZIPDecompressorInputStream in (new MemoryInputStream (data, numBytes, false), true,
+                                            GZIPDecompressorInputStream::gzipFormat);
+            in.readIntoMemoryBlock (text);
+        }
+        else
+        {
+            text.replaceAll (data, numBytes);
+        }
+
+        return parseXML (text.toString());
+    }
+
+    bool ProcessorGraph::restoreFromXmlData (const void* data, size_t numBytes)
+    {
+        const auto xml = parseXmlData (data, numBytes);
+
+        if (xml == nullptr || ! xml->hasTagName (ProcessorGraph::graphAttrName))
+            return false;
+
+        restoreFromXml (*xml);
+        return true;
+    }
+
+    //==============================================================================
+    /*  Binary graph format, all integers little-endian:
+
+        int32       magic ("PTGB")
+        int32       format version
+        layouts     packed int count, then one string per distinct AudioChannelSet
+        states      packed int count, then per distinct processor state: int64 size, raw bytes
+                    (since version 2)
+        nodes       packed int count, then per node:
+                        int32 uid, int32 factory ID,
+                        packed int property count, then per property: string name, uint8 type, value
+                        packed int input bus count, packed int layout index per bus, same for outputs
+                        packed int state index (version 1: int64 state size, raw state bytes)
+        connections packed int count, then per connection: int32 source uid, int32 source channel,
+                    int32 destination uid, int32 destination channel
+    */
+    enum class BinaryPropertyType : uint8
+    {
+        intValue = 0,
+        int64Value,
+        doubleValue,
+        boolValue,
+        stringValue
+    };
+
+    static std::optional<BinaryPropertyType> getBinaryPropertyType (const var& value)
+    {
+        if (value.isInt())      return BinaryPropertyType::intValue;
+        if (value.isInt64())    return BinaryPropertyType::int64Value;
+        if (value.isDouble())   return BinaryPropertyType::doubleValue;
+        if (value.isBool())     return BinaryPropertyType::boolValue;
+        if (value.isString())   return BinaryPropertyType::stringValue;
+        return std::nullopt;
+    }
+
+    static void writeProperty (OutputStream& out, const NamedValueSet::NamedValue& prop, BinaryPropertyType type)
+    {
+        out.writeString (prop.name.toString());
+        out.writeByte ((char) type);
+
+        switch (type)
+        {
+            case BinaryPropertyType::intValue:      out.writeInt ((int) prop.value); break;
+            case BinaryPropertyType::int64Value:    out.writeInt64 ((int64) prop.value); break;
+            case BinaryPropertyType::doubleValue:   out.writeDouble ((double) prop.value); break;
+            case BinaryPropertyType::boolValue:     out.writeBool ((bool) prop.value); break;
+            case BinaryPropertyType::stringValue:   out.writeString (prop.value.toString()); break;
+        }
+    }
+
+    static bool readProperty (InputStream& in, NamedValueSet& properties)
+    {
+        const auto name = in.readString();
+
+        switch ((BinaryPropertyType) (uint8) in.readByte())
+        {
+            case BinaryPropertyType::intValue:      properties.set (name, in.readInt()); return true;
+            case BinaryPropertyType::int64Value:    properties.set (name, in.readInt64()); return true;
+            case BinaryPropertyType::doubleValue:   properties.set (name, in.readDouble()); return true;
+            case BinaryPropertyType::boolValue:     properties.set (name, in.readBool()); return true;
+            case BinaryPropertyType::stringValue:   properties.set (name, in.readString()); return true;
+        }
+
+        return false;
+    }
+
+    MemoryBlock ProcessorGraph::createBinary() const
+    {
+        const auto nodes = graph.getNodes();
+
+        StringArray layoutTable;
+        for (auto* node : nodes)
+        {
+            const auto layout = node->getProcessor()->getBusesLayout();
+            for (auto isInput : { true, false })
+                for (const auto& bus : getBusLayoutStrings (layout, isInput))
+                    layoutTable.addIfNotAlreadyThere (bus);
+        }
+
+        StateTable states;
+        std::vector<int> stateIndices;
+
+        stateCache.beginSave();
+        for (auto* node : nodes)
+            stateIndices.push_back (states.add (stateCache.getState (node)));
+
+        MemoryOutputStream out;
+        out.writeInt (binaryMagic);
+        out.writeInt (binaryFormatVersion);
+
+        out.writeCompressedInt (layoutTable.size());
+        for (const auto& layout : layoutTable)
+            out.writeString (layout);
+
+        out.writeCompressedInt ((int) states.blobs.size());
+        for (const auto& state : states.blobs)
+        {
+            out.writeInt64 ((int64) state->getSize());
+            out.write (state->getData(), state->getSize());
+        }
+
+        out.writeCompressedInt (nodes.size());
+        for (int n = 0; n < nodes.size(); ++n)
+        {
+            auto* node = nodes.getObjectPointerUnchecked (n);
+            auto* processor = node->getProcessor();
+
+            out.writeInt ((int) node->nodeID.uid);
+            out.writeInt (node->properties.contains (factoryId) ? (int) node->properties[factoryId] : -1);
+
+            int numProperties = 0;
+            for (const auto& prop : node->properties)
+                if (getBinaryPropertyType (prop.value).has_value())
+                    ++numProperties;
+
+            out.writeCompressedInt (numProperties);
+            for (const auto& prop : node->properties)
+                if (const auto type = getBinaryPropertyType (prop.value))
+                    writeProperty (out, prop, *type);
+
+            const auto layout = processor->getBusesLayout();
+            for (auto isInput : { true, false })
+            {
+                const auto buses = getBusLayoutStrings (layout, isInput);
+                out.writeCompressedInt ((int) buses.size());
+                for (const auto& bus : buses)
+                    out.writeCompressedInt (layoutTable.indexOf (bus));
+            }
+
+            out.writeCompressedInt (stateIndices[(size_t) n]);
+        }
+
+        const auto connections = graph.getConnections();
+        out.writeCompressedInt ((int) connections.size());
+        for (const auto& connection : connections)
+        {
+            out.writeInt ((int) connection.source.nodeID.uid);
+            out.writeInt (connection.source.channelIndex);
+            out.writeInt ((int) connection.destination.nodeID.uid);
+            out.writeInt (connection.destination.channelIndex);
+        }
+
+        return out.getMemoryBlock();
+    }
+
+    std::optional<ProcessorGraph::SavedGraph> ProcessorGraph::readBinary (const void* data, size_t numBytes)
+    {
+        MemoryInputStream in (data, numBytes, false);
+
+        if (in.readInt() != binaryMagic)
+            return std::nullopt;
+
+        const auto version = in.readInt();
+        if (version < 1 || version > binaryFormatVersion)
+            return std::nullopt;
+
+        StringArray layoutTable;
+        for (int i = in.readCompressedInt(); --i >= 0 && ! in.isExhausted();)
+            layoutTable.add (in.readString());
+
+        const auto readState = [&in]() -> std::shared_ptr<const SavedState>
+        {
+            const auto stateSize = in.readInt64();
+            if (stateSize < 0 || stateSize > in.getNumBytesRemaining())
+                return nullptr;
+
+            MemoryBlock state;
+            in.readIntoMemoryBlock (state, (ssize_t) stateSize);
+            return std::make_shared<const SavedState> (std::move (state));
+        };
+
+        std::vector<std::shared_ptr<const SavedState>> stateTable;
+        if (version >= 2)
+        {
+            // every state takes at least the 8 bytes of its size
+            const auto numStates = in.readCompressedInt();
+            if (numStates < 0 || numStates > in.getNumBytesRemaining() / 8)
+                return std::nullopt;
+
+            for (int i = numStates; --i >= 0;)
+            {
+                auto state = readState();
+                if (state == nullptr)
+                    return std::nullopt;
+
+                stateTable.push_back (std::move (state));
+            }
+        }
+
+        const auto readBuses = [&in, &layoutTable] (std::vector<String>& buses)
+        {
+            for (int i = in.readCompressedInt(); --i >= 0 && ! in.isExhausted();)
+                buses.push_back (layoutTable[in.readCompressedInt()]);
+        };
+
+        SavedGraph saved;
+        const auto numNodes = in.readCompressedInt();
+
+        // the connection count always follows the nodes
+        if (in.isExhausted())
+            return std::nullopt;
+
+        for (int i = numNodes; --i >= 0;)
+        {
+            // the uid and factory index
+            if (in.getNumBytesRemaining() < 8)
+                return std::nullopt;
+
+            SavedNode node;
+            node.nodeID = NodeID ((uint32) in.readInt());
+            node.factoryIndex = in.readInt();
+
+            for (int p = in.readCompressedInt(); --p >= 0;)
+                if (in.isExhausted() || ! readProperty (in, node.properties))
+                    return std::nullopt;
+
+            node.hasLayout = true;
+            readBuses (node.inputBuses);
+            readBuses (node.outputBuses);
+
+            if (version >= 2)
+            {
+                const auto stateIndex = in.readCompressedInt();
+                if (! isPositiveAndBelow (stateIndex, (int) stateTable.size()))
+                    return std::nullopt;
+
+                node.state = stateTable[(size_t) stateIndex];
+            }
+            else if ((node.state = readState()) == nullptr)
+            {
+                return std::nullopt;
+            }
+
+            // a stream that ended inside the node read zeros for the rest of its fields
+            if (in.isExhausted())
+                return std::nullopt;
+
+            if (node.factoryIndex != -1)
+                saved.nodes.push_back (std::move (node));
+        }
+
+        for (int i = in.readCompressedInt(); --i >= 0;)
+        {
+            // two uids and two channels
+            if (in.getNumBytesRemaining() < 16)
+                return std::nullopt;
+
+            const auto srcUid = (uint32) in.readInt();
+            const auto srcChannel = in.readInt();
+            const auto dstUid = (uint32) in.readInt();
+            const auto dstChannel = in.readInt();
+            saved.connections.push_back ({ { NodeID (srcUid), srcChannel }, { NodeID (dstUid), dstChannel } });
+        }
+
+        return saved;
+    }
+
+    bool ProcessorGraph::restoreFromBinary (const void* data, size_t numBytes)
+    {
+        auto saved = readBinary (data, numBytes);
+
+        if (! saved.has_value())
+            return false;
+
+        cancelPendingLoad();
+        restoreFromSavedGraph (*saved);
+        return true;
+    }
+
+    std::optional<ProcessorGraph::SavedGraph> ProcessorGraph::readSavedGraph (const void* data, size_t numBytes)
+    {
+        if (numBytes >= sizeof (int) && (int) ByteOrder::littleEndianInt (data) == binaryMagic)
+            return readBinary (data, numBytes);
+
+        if (const auto xml = parseXmlData (data, numBytes))
+            return readXml (*xml);
+
+        return std::nullopt;
+    }
+
+    //==============================================================================
+    struct ProcessorGraph::LoadJob
+    {
+        std::unique_ptr<XmlElement> xml;
+        MemoryBlock binary;
+        LoadCallback onComplete;
+        double crossfadeSeconds = 0.0;
+        int generation = 0;
+    };
+
+    /**
+        Builds the processors of a saved graph on a background thread, then hands them back
+        to the message thread to be installed. A job that hasn't started yet is replaced by
+        a newer one.
+    */
+    class ProcessorGraph::AsyncLoader final
+    {
+    public:
+        explicit AsyncLoader (ProcessorGraph& g)
+            : owner (g), thread ("ProcessorGraph loader", [this] { return takeNextBuild(); })
+        {
+        }
+
+        void load (LoadJob job)
+        {
+            std::optional<LoadJob> superseded;
+
+            {
+                const ScopedLock sl (lock);
+                superseded = std::exchange (pendingJob, std::move (job));
+            }
+
+            if (superseded.has_value() && superseded->onComplete != nullptr)
+                MessageManager::callAsync ([callback = std::move (superseded->onComplete)] { callback (false); });
+
+            thread.notify();
+        }
+
+    private:
+        struct Result
+        {
+            LoadJob job;
+            std::optional<PreparedGraph> prepared;
+        };
+
+        GraphBuildThread::Build takeNextBuild()
+        {
+            auto result = std::make_shared<Result>();
+
+            {
+                const ScopedLock sl (lock);
+
+                if (! pendingJob.has_value())
+                    return {};
+
+                result->job = std::move (*pendingJob);
+                pendingJob.reset();
+            }
+
+            return [this, result] (const std::function<bool()>& shouldExit)
+            {
+                auto& job = result->job;
+                auto saved = job.xml != nullptr ? readXml (*job.xml)
+                                                : readBinary (job.binary.getData(), job.binary.getSize());
+
+                if (saved.has_value())
+                    result->prepared = owner.createPreparedGraph (std::move (*saved), shouldExit);
+
+                if (shouldExit())
+                    return;
+
+                MessageManager::callAsync ([graph = WeakReference<ProcessorGraph> (&owner), result]
+                {
+                    if (auto* g = graph.get())
+                        g->finishLoad (result->job, result->prepared);
+                });
+            };
+        }
+
+        ProcessorGraph& owner;
+        CriticalSection lock;
+        std::optional<LoadJob> pendingJob;
+
+        // declared last, so that it's stopped before the members it uses are destroyed
+        GraphBuildThread thread;
+    };
+
+    void ProcessorGraph::loadAsync (const XmlElement& xml, LoadCallback onComplete, double crossfadeSeconds)
+    {
+        LoadJob job;
+        job.xml = std::make_unique<XmlElement> (xml);
+        job.onComplete = std::move (onComplete);
+        job.crossfadeSeconds = crossfadeSeconds;
+        startLoad (std::move (job));
+    }
+
+    void ProcessorGraph::loadBinaryAsync (MemoryBlock data, LoadCallback onComplete, double crossfadeSeconds)
+    {
+        LoadJob job;
+        job.binary = std::move (data);
+        job.onComplete = std::move (onComplete);
+        job.crossfadeSeconds = crossfadeSeconds;
+        startLoad (std::move (job));
+    }
+
+    void ProcessorGraph::startLoad (LoadJob job)
+    {
+        job.generation = ++loadGeneration;
+        loadPending = true;
+
+        if (loader == nullptr)
+            loader = std::make_unique<AsyncLoader> (*this);
+
+        loader->load (std::move (job));
+    }
+
+    void ProcessorGraph::finishLoad (LoadJob& job, std::optional<PreparedGraph>& prepared)
+    {
+        const auto isCurrent = job.generation == loadGeneration;
+
+        if (isCurrent)
+            loadPending = false;
+
+        const auto success = isCurrent && prepared.has_value();
+
+        if (success)
+            swapInPreparedGraph (*prepared, job.crossfadeSeconds);
+
+        if (job.onComplete != nullptr)
+            job.onComplete (success);
+    }
+
+    ProcessorGraph::PreparedGraph ProcessorGraph::createPreparedGraph (SavedGraph saved, const std::function<bool()>& shouldAbort)
+    {
+        PreparedGraph prepared;
+
+        // only the render engine keeps processors that were prepared ahead of time;
+        // AudioProcessorGraph prepares the nodes it's given itself
+        if (renderEngine != nullptr)
+        {
+            prepared.sampleRate = preparedSampleRate;
+            prepared.blockSize = preparedBlockSize;
+        }
+
+        prepared.processors = createProcessorsFromSavedGraph (saved, prepared.sampleRate, prepared.blockSize, shouldAbort);
+        prepared.saved = std::move (saved);
+        return prepared;
+    }
+
+    void ProcessorGraph::installPreparedGraph (PreparedGraph& prepared, double crossfadeSeconds)
+    {
+        cancelPendingLoad();
+        swapInPreparedGraph (prepared, crossfadeSeconds);
+    }
+
+    void ProcessorGraph::swapInPreparedGraph (PreparedGraph& prepared, double crossfadeSeconds)
+    {
+        if (renderEngine != nullptr && crossfadeSeconds > 0.0)
+            renderEngine->crossfadeToNextPlan (crossfadeSeconds);
+
+        const ScopedTransaction transaction (*this);
+
+        clear();
+        for (size_t i = 0; i < prepared.processors.size(); ++i)
+        {
+            auto node = addSavedNode (prepared.saved.nodes[i], std::move (prepared.processors[i]));
+
+            if (node != nullptr && renderEngine != nullptr)
+                renderEngine->adoptPreparedNode (node, prepared.sampleRate, prepared.blockSize);
+        }
+        for (const auto& connection : prepared.saved.connections)
+            addConnection (connection);
+        graph.removeIllegalConnections (getUpdateKind());
+    }
+
+    void ProcessorGraph::cancelPendingLoad()
+    {
+        // the loader's result is discarded once it arrives
+        ++loadGeneration;
+        loadPending = false;
+    }
+
+    void ProcessorGraph::addConnection (const AudioProcessorGraph::Connection& connection)
+    {
+        graph.addConnection (connection, getUpdateKind());
+        topologyChanged();
+        notifyConnectionAdded(connection);
+        instantiateReachablePlaceholders();
+    }
+
+    void ProcessorGraph::removeConnection (const AudioProcessorGraph::Connection& connection)
+    {
+        graph.removeConnection (connection, getUpdateKind());
+        connectionGains.remove (connection);
+        topologyChanged();
+        notifyConnectionRemoved(connection);
+    }
+
+    void ProcessorGraph::removeNode (NodeID nodeID)
+    {
+        if (auto* node = graph.getNodeForId (nodeID))
+        {
+            graph.removeNode (node, getUpdateKind());
+            stateCache.removeStale (graph);
+            topologyChanged();
+            notifyNodeRemoved(nodeID);
+        }
+    }
+
+    void ProcessorGraph::removeNode (const AudioProcessorGraph::Node::Ptr& node)
     {
         if (node != nullptr)
             removeNode (node->nodeID);
@@ -342,11 +1448,12 @@ namespace PlayfulTones {
         if (graph.getNodeForId (nodeID) == nullptr)
             return;
 
+        const ScopedTransaction transaction (*this);
         const auto connections = graph.getConnections();
-        graph.disconnectNode(nodeID);
+        graph.disconnectNode(nodeID, getUpdateKind());
         for (const auto& c : connections)
             if (c.source.nodeID == nodeID || c.destination.nodeID == nodeID)
-                graphListeners.call(&Listener::connectionRemoved, c);
+                notifyConnectionRemoved(c);
     }
 
     void ProcessorGraph::disconnectNode (const AudioProcessorGraph::Node::Ptr& node)
@@ -357,7 +1464,7 @@ namespace PlayfulTones {
 
     juce::AudioProcessorGraph::Node::Ptr ProcessorGraph::createModule (int factoryIndex, double x, double y, bool isInteractable)
     {
-        auto node = graph.addNode (factory.createProcessor(factoryIndex));
+        auto node = graph.addNode (factory.createProcessor(factoryIndex), {}, getUpdateKind());
         if(node == nullptr)
             return nullptr;
         node->getProcessor()->enableAllBuses();
@@ -366,10 +1473,121 @@ namespace PlayfulTones {
         node->properties.set(factoryId, factoryIndex);
         node->properties.set(instanceId, getNextInstanceId(factoryIndex));
         node->properties.set(isInteractableId, isInteractable);
-        graphListeners.call(&Listener::nodeAdded, node->nodeID);
+        topologyChanged();
+        notifyNodeAdded(node->nodeID);
         return node;
     }
 
+    bool ProcessorGraph::isPlaceholder (NodeID nodeID) const
+    {
+        if (auto* node = graph.getNodeForId (nodeID))
+            return dynamic_cast<PlaceholderProcessor*> (node->getProcessor()) != nullptr;
+
+        return false;
+    }
+
+    AudioProcessorGraph::Node::Ptr ProcessorGraph::instantiateNode (NodeID nodeID)
+    {
+        AudioProcessorGraph::Node::Ptr node = graph.getNodeForId (nodeID);
+
+        if (node == nullptr)
+            return nullptr;
+
+        auto* placeholder = dynamic_cast<PlaceholderProcessor*> (node->getProcessor());
+
+        if (placeholder == nullptr)
+            return node;
+
+        auto processor = createProcessorFromSavedNode (placeholder->getSavedNode());
+
+        if (processor == nullptr)
+            return node;
+
+        const ScopedTransaction transaction (*this);
+
+        std::vector<AudioProcessorGraph::Connection> connections;
+        for (const auto& c : graph.getConnections())
+            if (c.source.nodeID == nodeID || c.destination.nodeID == nodeID)
+                connections.push_back (c);
+
+        graph.removeNode (nodeID, getUpdateKind());
+        for (const auto& c : connections)
+            notifyConnectionRemoved (c);
+        notifyNodeRemoved (nodeID);
+
+        auto newNode = graph.addNode (std::move (processor), nodeID, getUpdateKind());
+        if (newNode == nullptr)
+            return nullptr;
+
+        newNode->properties = node->properties;
+        newNode->setBypassed (node->isBypassed());
+        notifyNodeAdded (nodeID);
+
+        // the real processor may not take every connection the placeholder had
+        for (const auto& c : connections)
+            if (graph.addConnection (c, getUpdateKind()))
+                notifyConnectionAdded (c);
+
+        stateCache.removeStale (graph);
+        return newNode;
+    }
+
+    void ProcessorGraph::instantiateReachablePlaceholders()
+    {
+        if (isInTransaction())
+            return;
+
+        const auto nodes = graph.getNodes();
+        std::unordered_map<uint32, AudioProcessorGraph::Node*> placeholders;
+        std::vector<uint32> toVisit;
+
+        for (auto* node : nodes)
+        {
+            auto* processor = node->getProcessor();
+
+            if (dynamic_cast<PlaceholderProcessor*> (processor) != nullptr)
+                placeholders[node->nodeID.uid] = node;
+            else if (processor->getTotalNumOutputChannels() == 0 && ! processor->producesMidi())
+                toVisit.push_back (node->nodeID.uid);
+        }
+
+        if (placeholders.empty())
+            return;
+
+        std::unordered_multimap<uint32, uint32> sourcesOf;
+        for (const auto& c : graph.getConnections())
+            sourcesOf.emplace (c.destination.nodeID.uid, c.source.nodeID.uid);
+
+        std::unordered_set<uint32> visited (toVisit.begin(), toVisit.end());
+        std::vector<NodeID> reachable;
+
+        while (! toVisit.empty())
+        {
+            const auto uid = toVisit.back();
+            toVisit.pop_back();
+
+            const auto [begin, end] = sourcesOf.equal_range (uid);
+            for (auto it = begin; it != end; ++it)
+            {
+                if (! visited.insert (it->second).second)
+                    continue;
+
+                if (placeholders.count (it->second) > 0)
+                    reachable.push_back (NodeID (it->second));
+
+                toVisit.push_back (it->second);
+            }
+        }
+
+        if (reachable.empty())
+            return;
+
+        const ScopedTransaction transaction (*this);
+
+        for (auto nodeID : reachable)
+            instantiateNode (nodeID);
+    }
+
     void ProcessorGraph::addListener (ProcessorGraph::Listener* newListener)
     {
         graphListeners.add (newListener);
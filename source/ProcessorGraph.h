@@ -5,7 +5,9 @@
 #pragma once
 using namespace juce;
 namespace PlayfulTones {
-    class ProcessorGraph
+    class RenderEngine;
+
+    class ProcessorGraph : private ChangeListener
     {
     public:
         //==============================================================================
@@ -143,6 +145,27 @@ namespace PlayfulTones {
                 return copy;
             }
 
+            [[nodiscard]] GuiConfig withNodeTimingOverlay(bool enabled) const
+            {
+                auto copy = *this;
+                copy.showNodeTimings = enabled;
+                return copy;
+            }
+
+            [[nodiscard]] GuiConfig withSingleLayerConnections(bool enabled) const
+            {
+                auto copy = *this;
+                copy.drawConnectionsInSingleLayer = enabled;
+                return copy;
+            }
+
+            [[nodiscard]] GuiConfig withZoomableCanvas(bool enabled) const
+            {
+                auto copy = *this;
+                copy.useZoomableCanvas = enabled;
+                return copy;
+            }
+
             /*
              * Allow the creation of new processors from the context menu (by right-clicking on the background).
              */
@@ -230,12 +253,158 @@ namespace PlayfulTones {
              * Save the node state as a text file instead of a binary file
              */
             bool saveNodeStateAsTextFile = false;
+
+            /*
+             * Tint each node by its share of the audio budget and show the percentage on it.
+             * Requires PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING and ProcessorGraph's own renderer.
+             */
+            bool showNodeTimings = true;
+
+            /*
+             * Draw all connections from one layer instead of a component per connection,
+             * which keeps painting and mouse handling fast in dense graphs.
+             */
+            bool drawConnectionsInSingleLayer = false;
+
+            /*
+             * Place the nodes on a canvas that can be panned and zoomed, instead of scaling their
+             * positions to the size of the graph view. Node positions are then no longer limited
+             * to 0..1, and only the nodes and connections in view get components.
+             */
+            bool useZoomableCanvas = false;
         };
 
+        /**
+            Configuration options for rendering.
+        */
+        struct RenderConfig
+        {
+            RenderConfig() {}
+
+            [[nodiscard]] RenderConfig withParallelRendering(bool enabled) const
+            {
+                auto copy = *this;
+                copy.enableParallelRendering = enabled;
+                return copy;
+            }
+
+            [[nodiscard]] RenderConfig withNumWorkerThreads(int numThreads) const
+            {
+                auto copy = *this;
+                copy.numWorkerThreads = numThreads;
+                return copy;
+            }
+
+            [[nodiscard]] RenderConfig withSerialProcessingThreshold(int numNodes) const
+            {
+                auto copy = *this;
+                copy.serialProcessingThreshold = numNodes;
+                return copy;
+            }
+
+            [[nodiscard]] RenderConfig withBackgroundPlanCompilation(bool enabled) const
+            {
+                auto copy = *this;
+                copy.enableBackgroundPlanCompilation = enabled;
+                return copy;
+            }
+
+            [[nodiscard]] RenderConfig withSilenceSleeping(bool enabled) const
+            {
+                auto copy = *this;
+                copy.enableSilenceSleeping = enabled;
+                return copy;
+            }
+
+            [[nodiscard]] RenderConfig withDeadNodePruning(bool enabled) const
+            {
+                auto copy = *this;
+                copy.enableDeadNodePruning = enabled;
+                return copy;
+            }
+
+            [[nodiscard]] RenderConfig withBypassFolding(bool enabled) const
+            {
+                auto copy = *this;
+                copy.enableBypassFolding = enabled;
+                return copy;
+            }
+
+            [[nodiscard]] RenderConfig withChainFusion(bool enabled) const
+            {
+                auto copy = *this;
+                copy.enableChainFusion = enabled;
+                return copy;
+            }
+
+            [[nodiscard]] RenderConfig withBufferPooling(bool enabled) const
+            {
+                auto copy = *this;
+                copy.enableBufferPooling = enabled;
+                return copy;
+            }
+
+            /*
+             * Render with ProcessorGraph's own engine, which processes the independent nodes of each
+             * dependency level concurrently, instead of AudioProcessorGraph's serial renderer.
+             */
+            bool enableParallelRendering = false;
+
+            /*
+             * The number of real-time worker threads helping the audio thread. A negative value uses
+             * one thread per CPU core, minus one for the audio thread.
+             */
+            int numWorkerThreads = -1;
+
+            /*
+             * Graphs with fewer nodes than this are always processed serially on the audio thread.
+             */
+            int serialProcessingThreshold = 8;
+
+            /*
+             * Compile the render plan for a topology edit on a background thread instead of the message
+             * thread. Either way the audio thread picks the new plan up with an atomic pointer swap.
+             */
+            bool enableBackgroundPlanCompilation = true;
+
+            /*
+             * Stop processing a node once its inputs have been silent for longer than its tail length,
+             * passing silence downstream instead, and wake it when audio or MIDI arrives. This uses
+             * ProcessorGraph's own engine, even when parallel rendering is disabled.
+             */
+            bool enableSilenceSleeping = false;
+
+            /*
+             * Skip the nodes whose output never reaches an output node, or a node without outputs such
+             * as a meter. Only applies to ProcessorGraph's own engine.
+             */
+            bool enableDeadNodePruning = true;
+
+            /*
+             * Skip bypassed nodes that have no bypass parameter and as many inputs as outputs, handing
+             * their input straight to the nodes they feed. Only applies to ProcessorGraph's own engine.
+             */
+            bool enableBypassFolding = true;
+
+            /*
+             * Render serial chains of nodes, where each node only feeds the next one channel for channel,
+             * as a single op that processes one buffer in place. This saves a buffer copy and a scheduling
+             * step per node. Only applies to ProcessorGraph's own engine.
+             */
+            bool enableChainFusion = true;
+
+            /*
+             * Let nodes share intermediate buffer channels when their lifetimes in the render order don't
+             * overlap, and let a node process its input in the buffer it arrived in when nothing else reads
+             * it. getRenderPlanDiagnostics() reports the resulting buffer memory. Only applies to
+             * ProcessorGraph's own engine.
+             */
+            bool enableBufferPooling = true;
+        };
 
         //==============================================================================
-        explicit ProcessorGraph (ModuleFactory factory, GuiConfig guiConfig = GuiConfig());
-        ~ProcessorGraph();
+        explicit ProcessorGraph (ModuleFactory factory, GuiConfig guiConfig = GuiConfig(), RenderConfig renderConfig = RenderConfig());
+        ~ProcessorGraph() override;
 
         //==============================================================================
         using NodeID = AudioProcessorGraph::NodeID;
@@ -243,6 +412,52 @@ namespace PlayfulTones {
         void setNodePosition (NodeID, Point<double>) const;
         Point<double> getNodePosition (NodeID) const;
 
+        //==============================================================================
+        /** Prepares the graph for playback.
+            Without parallel rendering this simply forwards to the AudioProcessorGraph.
+        */
+        void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock);
+        void releaseResources();
+        void processBlock (AudioBuffer<float>&, MidiBuffer&);
+
+        /** Returns true if the graph is rendered by ProcessorGraph's own engine, which the
+            RenderConfig turns on with parallel rendering or silence sleeping.
+        */
+        [[nodiscard]] bool usesOwnRenderer() const noexcept    { return renderEngine != nullptr; }
+
+        /** Returns the number of worker threads the parallel renderer currently uses. */
+        [[nodiscard]] int getNumRenderThreads() const;
+
+        /** Returns how long a node has been spending in processBlock().
+            Timings are only collected by ProcessorGraph's own renderer, and only when
+            PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING is set; otherwise this returns nullopt.
+        */
+        [[nodiscard]] std::optional<NodeTiming> getNodeTiming (NodeID) const;
+
+        /** Returns whether a node is asleep and how many blocks it has skipped.
+            Returns nullopt unless RenderConfig::enableSilenceSleeping is set.
+        */
+        [[nodiscard]] std::optional<NodeSleepState> getNodeSleepState (NodeID) const;
+
+        /** Restarts every node's timing and sleep counters. */
+        void resetNodeStatistics();
+
+        /** Returns the nodes that ProcessorGraph's own renderer currently leaves out, because they
+            can't be heard or are bypassed, the chains it renders as one and the buffer memory it uses.
+            Returns nullopt when the graph renders with AudioProcessorGraph.
+        */
+        [[nodiscard]] std::optional<RenderPlanDiagnostics> getRenderPlanDiagnostics() const;
+
+        /** Bypasses a node, updating the render plan straight away. */
+        void setNodeBypassed (NodeID, bool shouldBeBypassed);
+
+        /** Scales the audio a connection carries, applied as the connections to an input are summed.
+            Changing a gain that has been set before doesn't recompile the render plan. Gains aren't
+            saved with the graph, and only apply when the graph renders with its own engine.
+        */
+        void setConnectionGain (const AudioProcessorGraph::Connection&, float gain);
+        [[nodiscard]] float getConnectionGain (const AudioProcessorGraph::Connection&) const;
+
         //==============================================================================
         void clear();
 
@@ -250,6 +465,174 @@ namespace PlayfulTones {
         std::unique_ptr<XmlElement> createXml() const;
         void restoreFromXml (const XmlElement&);
 
+        /** Makes createXml() GZIP-compress the state of every node whose state is at least this
+            many bytes, marking its STATE element with a codec attribute. States that don't get
+            smaller are stored as they are. A negative value, the default, disables compression.
+        */
+        void setStateCompressionThreshold (int numBytes) noexcept    { stateCompressionThreshold = numBytes; }
+
+        /** Writes createXml() as an XML document, optionally GZIP-compressing the whole of it.
+            When the document is compressed, compressing the node states as well rarely helps.
+        */
+        MemoryBlock createXmlData (bool compress) const;
+
+        /** Restores a document written by createXmlData(), or any XML text containing a graph
+            saved by createXml(), whether it's compressed or not. Returns false, leaving the graph
+            untouched, if the data doesn't hold a graph.
+        */
+        bool restoreFromXmlData (const void* data, size_t numBytes);
+
+        /** Saves the graph in a compact, versioned binary format. Processor state is stored as raw
+            bytes and properties keep their types, so this is much cheaper than createXml() for
+            large states. Use the XML format for interchange.
+        */
+        MemoryBlock createBinary() const;
+
+        /** Restores a graph saved by createBinary(). Returns false, leaving the graph untouched,
+            if the data isn't in a format this version understands or is truncated.
+        */
+        bool restoreFromBinary (const void* data, size_t numBytes);
+
+        /** Makes the next save call getStateInformation() on a node again.
+
+            createXml() and createBinary() reuse a node's previously saved state until one of its
+            parameters changes or its processor reports a state change with updateHostDisplay().
+            Call this after changing a processor's state in a way the host isn't told about.
+            Node properties aren't cached, so editing them needs no invalidation.
+        */
+        void markDirty (NodeID);
+
+        /** Returns how many nodes the saves have serialized, and how many they took from the cache. */
+        [[nodiscard]] StateCacheStatistics getStateCacheStatistics() const;
+
+        /** A processor state read from a saved graph. Nodes that were saved with identical
+            states share a single SavedState.
+        */
+        class SavedState
+        {
+        public:
+            explicit SavedState (MemoryBlock data);
+
+            /** Keeps a Base64 state read from XML, which is decoded (and decompressed, if it was
+                saved compressed) the first time it's needed.
+            */
+            explicit SavedState (String base64, bool isCompressed = false);
+
+            /** Returns the state's bytes. Safe to call from several threads at once. */
+            const MemoryBlock& getData() const;
+
+        private:
+            String encoded;
+            bool isCompressed = false;
+            mutable MemoryBlock data;
+            mutable std::once_flag decodeFlag;
+
+            JUCE_DECLARE_NON_COPYABLE (SavedState)
+        };
+
+        /** A node's saved state, independent of the format it was stored in. */
+        struct SavedNode
+        {
+            NodeID nodeID;
+            int factoryIndex = -1;
+            NamedValueSet properties;
+            bool hasLayout = false;
+            std::vector<String> inputBuses, outputBuses;
+            std::shared_ptr<const SavedState> state;
+        };
+
+        /** A saved graph, independent of the format it was stored in. */
+        struct SavedGraph
+        {
+            std::vector<SavedNode> nodes;
+            std::vector<AudioProcessorGraph::Connection> connections;
+        };
+
+        //==============================================================================
+        /** Called on the message thread when an asynchronous load has finished. The argument is
+            false if the data couldn't be read, or if the load was superseded by a later one.
+        */
+        using LoadCallback = std::function<void (bool success)>;
+
+        /**
+            Loads a graph saved by createXml() without blocking the calling thread.
+
+            The processors are constructed, restored and (with ProcessorGraph's own renderer)
+            prepared on a background thread, so they mustn't depend on being created on the
+            message thread. The finished graph then replaces the current one in a single
+            transaction, and the audio thread switches over at a block boundary. With
+            ProcessorGraph's own renderer, a non-zero crossfadeSeconds fades from the old
+            graph's output to the new one's.
+
+            A load that hasn't been installed yet is cancelled by a later load or restore.
+        */
+        void loadAsync (const XmlElement&, LoadCallback onComplete = {}, double crossfadeSeconds = 0.0);
+
+        /** Like loadAsync(), for data saved by createBinary(). */
+        void loadBinaryAsync (MemoryBlock, LoadCallback onComplete = {}, double crossfadeSeconds = 0.0);
+
+        [[nodiscard]] bool isLoading() const noexcept    { return loadPending; }
+
+        //==============================================================================
+        /** Reads a graph saved by createBinary() or createXmlData() without touching this one.
+            Returns nullopt if the data isn't in a format this version understands.
+        */
+        static std::optional<SavedGraph> readSavedGraph (const void* data, size_t numBytes);
+
+        /** A saved graph whose processors have already been constructed and restored, ready to
+            replace the current graph. @see createPreparedGraph, installPreparedGraph
+        */
+        struct PreparedGraph
+        {
+            SavedGraph saved;
+            std::vector<std::unique_ptr<AudioProcessor>> processors;
+            double sampleRate = 0.0;
+            int blockSize = 0;
+        };
+
+        /** Builds the processors of a saved graph. Safe to call from any thread.
+
+            With ProcessorGraph's own renderer the processors are also prepared with the settings
+            the graph is currently playing at, so installing them doesn't prepare them again.
+            Returns early, with some processors missing, if shouldAbort returns true.
+        */
+        PreparedGraph createPreparedGraph (SavedGraph, const std::function<bool()>& shouldAbort = nullptr);
+
+        /** Replaces the graph with a prepared one in a single transaction, cancelling any pending
+            asynchronous load. Must be called on the message thread.
+        */
+        void installPreparedGraph (PreparedGraph&, double crossfadeSeconds = 0.0);
+
+        /**
+            Sets how many pool threads help construct and restore processors when a graph is
+            restored or loaded, on top of the calling thread. A negative value uses one per
+            CPU core, minus one. By default this is 0, which restores every node on the
+            calling thread.
+
+            With helper threads, processor constructors and setStateInformation() run
+            concurrently, so they mustn't share unsynchronised state. Nodes are still inserted
+            and announced to listeners in their saved order.
+        */
+        void setNumRestoreThreads (int numThreads);
+
+        /**
+            Makes restores and loads create a PlaceholderProcessor instead of the real processor
+            for every node that can't be heard: one that doesn't feed, directly or through other
+            nodes, a node without audio outputs, such as the graph's output. Disabled by default.
+
+            A placeholder is replaced by its real processor as soon as a connection makes it
+            audible, or when its editor is opened. Nodes whose editor was open when the graph was
+            saved, and nodes saved without a bus layout, are always created.
+        */
+        void setLazyInstantiation (bool enabled) noexcept    { lazyInstantiation = enabled; }
+
+        /** Replaces a node's placeholder with its real processor, keeping the node's ID,
+            properties and connections. Returns the node, or nullptr if there's no such node.
+        */
+        AudioProcessorGraph::Node::Ptr instantiateNode (NodeID);
+
+        [[nodiscard]] bool isPlaceholder (NodeID) const;
+
         juce::AudioProcessorGraph::Node::Ptr createModule (int factoryId, double x = .5, double y = .5, bool isInteractable = true);
         void addConnection(const AudioProcessorGraph::Connection&);
         void removeConnection(const AudioProcessorGraph::Connection&);
@@ -259,6 +642,53 @@ namespace PlayfulTones {
         void disconnectNode(NodeID);
         void disconnectNode(const AudioProcessorGraph::Node::Ptr&);
 
+        //==============================================================================
+        /**
+            Starts batching edits. Until the matching commit(), node and connection edits
+            don't rebuild the graph and listener callbacks are queued. Transactions can be nested;
+            only the outermost commit() takes effect.
+
+            @see commit, ScopedTransaction
+        */
+        void beginTransaction();
+
+        /** Ends a transaction, rebuilding the graph once and notifying listeners with a single
+            Listener::changesCommitted() call.
+        */
+        void commit();
+
+        [[nodiscard]] bool isInTransaction() const noexcept    { return transactionDepth > 0; }
+
+        /** Begins a transaction on construction and commits it on destruction. */
+        struct ScopedTransaction
+        {
+            explicit ScopedTransaction (ProcessorGraph& g) : owner (g)    { owner.beginTransaction(); }
+            ~ScopedTransaction()                                          { owner.commit(); }
+
+            ProcessorGraph& owner;
+
+            JUCE_DECLARE_NON_COPYABLE (ScopedTransaction)
+        };
+
+        /**
+            The net effect of the edits made during a transaction.
+
+            A node or connection that was added and removed again within the transaction doesn't
+            appear at all. One that already existed and was removed and added again, such as a node
+            whose processor was replaced, appears in both lists, and should be treated as removed
+            before it was added.
+        */
+        struct ChangeSet
+        {
+            [[nodiscard]] bool isEmpty() const noexcept
+            {
+                return nodesAdded.empty() && nodesRemoved.empty() && connectionsAdded.empty() && connectionsRemoved.empty();
+            }
+
+            std::vector<NodeID> nodesAdded, nodesRemoved;
+            std::vector<AudioProcessorGraph::Connection> connectionsAdded, connectionsRemoved;
+        };
+
         //==============================================================================
 
         /**
@@ -275,6 +705,17 @@ namespace PlayfulTones {
             virtual void connectionAdded (const AudioProcessorGraph::Connection&) {}
             virtual void connectionRemoved (const AudioProcessorGraph::Connection&) {}
             virtual void graphIsAboutToBeCleared() {}
+
+            /** Called once when a transaction is committed, with the net changes it made.
+                By default this forwards them to the individual callbacks above, removals first.
+            */
+            virtual void changesCommitted (const ChangeSet& changes)
+            {
+                for (const auto& c : changes.connectionsRemoved)  connectionRemoved (c);
+                for (auto id : changes.nodesRemoved)               nodeRemoved (id);
+                for (auto id : changes.nodesAdded)                 nodeAdded (id);
+                for (const auto& c : changes.connectionsAdded)    connectionAdded (c);
+            }
         };
 
         /** Registers a listener to receive events when this graph's state changes.
@@ -296,6 +737,7 @@ namespace PlayfulTones {
         AudioProcessorGraph graph;
         ModuleFactory factory;
         const GuiConfig guiConfig;
+        const RenderConfig renderConfig;
 
         //==============================================================================
         static inline const juce::String xPosId = "x";
@@ -315,6 +757,10 @@ namespace PlayfulTones {
         static inline const juce::String stringValue = "string";
 
         static inline const juce::String stateAttrName = "STATE";
+        static inline const juce::String sharedStatesAttrName = "STATES";
+        static inline const juce::String stateRefAttrName = "ref";
+        static inline const juce::String codecAttrName = "codec";
+        static inline const juce::String gzipCodec = "gzip";
         static inline const juce::String propertyAttrName = "PROPERTY";
         static inline const juce::String graphAttrName = "FILTERGRAPH";
         static inline const juce::String connectionAttrName = "CONNECTION";
@@ -330,10 +776,61 @@ namespace PlayfulTones {
         static inline const juce::String indexAttrName = "index";
         static inline const juce::String disabledAttrValue = "disabled";
 
+        static constexpr int binaryMagic = 0x42475450; // "PTGB"
+        static constexpr int binaryFormatVersion = 2;
+
     private:
         //==============================================================================
 
-        AudioProcessorGraph::Node::Ptr createNodeFromXml (const XmlElement&);
+        class AsyncLoader;
+        struct LoadJob;
+
+        static std::optional<SavedGraph> readXml (const XmlElement&);
+        static std::optional<SavedGraph> readBinary (const void* data, size_t numBytes);
+
+        std::unique_ptr<AudioProcessor> createProcessorFromSavedNode (const SavedNode&);
+        std::vector<std::unique_ptr<AudioProcessor>> createProcessorsFromSavedGraph (const SavedGraph&, double sampleRate, int blockSize,
+                                                                                     const std::function<bool()>& shouldAbort = nullptr);
+        AudioProcessorGraph::Node::Ptr addSavedNode (const SavedNode&, std::unique_ptr<AudioProcessor>);
+        void restoreFromSavedGraph (const SavedGraph&);
+
+        void startLoad (LoadJob);
+        void finishLoad (LoadJob&, std::optional<PreparedGraph>&);
+        void swapInPreparedGraph (PreparedGraph&, double crossfadeSeconds);
+        void cancelPendingLoad();
+
+        void instantiateReachablePlaceholders();
+
+        void changeListenerCallback (ChangeBroadcaster*) override;
+        void topologyChanged();
+        [[nodiscard]] AudioProcessorGraph::UpdateKind getUpdateKind() const;
+
+        void notifyNodeAdded (NodeID);
+        void notifyNodeRemoved (NodeID);
+        void notifyConnectionAdded (const AudioProcessorGraph::Connection&);
+        void notifyConnectionRemoved (const AudioProcessorGraph::Connection&);
+
+        int transactionDepth = 0;
+        ChangeSet pendingChanges;
+
+        ConnectionGains connectionGains;
+        std::unique_ptr<RenderEngine> renderEngine;
+
+        // the settings the render engine was prepared with, read by loading threads
+        std::atomic<double> preparedSampleRate { 0.0 };
+        std::atomic<int> preparedBlockSize { 0 };
+
+        std::unique_ptr<AsyncLoader> loader;
+
+        CriticalSection restorePoolLock;
+        std::shared_ptr<ThreadPool> restorePool;
+        int numRestoreThreads = 0;
+        int stateCompressionThreshold = -1;
+        std::atomic<bool> lazyInstantiation { false };
+        int loadGeneration = 0;
+        bool loadPending = false;
+
+        mutable NodeStateCache stateCache;
 
         XmlElement restoredState { "RestoredState" };
 
@@ -342,6 +839,7 @@ namespace PlayfulTones {
         std::map<int, int> factoryIdToNextInstanceIdMap;
         int getNextInstanceId(int factoryId);
 
+        JUCE_DECLARE_WEAK_REFERENCEABLE (ProcessorGraph)
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProcessorGraph)
     };
 } // namespace PlayfulTones
@@ -0,0 +1,822 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+namespace PlayfulTones {
+    //==============================================================================
+    /**
+        A pool of real-time threads that, together with the audio thread, runs the ops of
+        one dependency level.
+
+        The tasks of a level are split into one contiguous slice per participant. Each
+        participant drains its own slice first, then steals from the others. A slice is a
+        single packed atomic (generation, end, next), so a claim can only succeed for the
+        job that is currently running and never needs a lock.
+    */
+    class RenderEngine::WorkerPool
+    {
+    public:
+        using Task = void (*) (void* context, int index);
+
+        explicit WorkerPool (int numWorkers)
+            : slices ((size_t) numWorkers + 1)
+        {
+            for (int i = 0; i < numWorkers; ++i)
+            {
+                auto* worker = threads.add (new Worker (*this, i + 1));
+
+                if (! worker->startRealtimeThread (Thread::RealtimeOptions{}.withPriority (10)))
+                    worker->startThread (Thread::Priority::highest);
+            }
+        }
+
+        ~WorkerPool()
+        {
+            for (auto* worker : threads)
+            {
+                worker->signalThreadShouldExit();
+                worker->wakeEvent.signal();
+            }
+
+            for (auto* worker : threads)
+                worker->stopThread (1000);
+        }
+
+        [[nodiscard]] int getNumWorkers() const    { return threads.size(); }
+
+        /** Wakes the workers up. They spin between levels until endBlock() is called. */
+        void beginBlock()
+        {
+            active.store (true, std::memory_order_release);
+
+            for (auto* worker : threads)
+                worker->wakeEvent.signal();
+        }
+
+        void endBlock()
+        {
+            active.store (false, std::memory_order_release);
+        }
+
+        /** Runs task (context, i) for every i in [0, numTasks) and returns once all of them have finished. */
+        void run (int numTasks, Task task, void* context)
+        {
+            jassert (numTasks <= 0xffff);
+
+            currentTask.store (task, std::memory_order_relaxed);
+            currentContext.store (context, std::memory_order_relaxed);
+            remaining.store (numTasks, std::memory_order_relaxed);
+
+            if (++lastGeneration == 0)
+                ++lastGeneration;
+
+            const auto numParticipants = (int) slices.size();
+
+            for (int p = 0; p < numParticipants; ++p)
+                slices[(size_t) p].state.store (pack (lastGeneration,
+                                                      numTasks * (p + 1) / numParticipants,
+                                                      numTasks * p / numParticipants),
+                                                std::memory_order_relaxed);
+
+            generation.store (lastGeneration, std::memory_order_release);
+
+            participate (0, lastGeneration);
+
+            while (remaining.load (std::memory_order_acquire) > 0)
+                std::this_thread::yield();
+        }
+
+    private:
+        //==============================================================================
+        class Worker final : public Thread
+        {
+        public:
+            Worker (WorkerPool& p, int participantIndex)
+                : Thread ("ProcessorGraph worker " + String (participantIndex)),
+                  pool (p), index (participantIndex)
+            {
+            }
+
+            void run() override
+            {
+                uint32 lastSeenGeneration = 0;
+
+                while (! threadShouldExit())
+                {
+                    if (! pool.active.load (std::memory_order_acquire))
+                    {
+                        wakeEvent.wait (-1);
+                        continue;
+                    }
+
+                    const auto gen = pool.generation.load (std::memory_order_acquire);
+
+                    if (gen != lastSeenGeneration)
+                    {
+                        lastSeenGeneration = gen;
+                        pool.participate (index, gen);
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            WaitableEvent wakeEvent;
+
+        private:
+            WorkerPool& pool;
+            const int index;
+        };
+
+        struct alignas (64) Slice
+        {
+            std::atomic<uint64> state { 0 };
+        };
+
+        static uint64 pack (uint32 gen, int end, int next)
+        {
+            return ((uint64) gen << 32) | ((uint64) (uint16) end << 16) | (uint64) (uint16) next;
+        }
+
+        static uint32 getGeneration (uint64 s)    { return (uint32) (s >> 32); }
+        static int getEnd (uint64 s)              { return (int) ((s >> 16) & 0xffff); }
+        static int getNext (uint64 s)             { return (int) (s & 0xffff); }
+
+        void participate (int participant, uint32 gen)
+        {
+            const auto numParticipants = (int) slices.size();
+
+            for (int i = 0; i < numParticipants; ++i)
+            {
+                auto& state = slices[(size_t) ((participant + i) % numParticipants)].state;
+                auto s = state.load (std::memory_order_acquire);
+
+                while (getGeneration (s) == gen && getNext (s) < getEnd (s))
+                {
+                    // on failure s is reloaded, so the loop condition is re-evaluated
+                    if (! state.compare_exchange_weak (s, s + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                        continue;
+
+                    // a successful claim means this job is still running, so the task can't have been replaced yet
+                    currentTask.load (std::memory_order_relaxed) (currentContext.load (std::memory_order_relaxed), getNext (s));
+                    remaining.fetch_sub (1, std::memory_order_acq_rel);
+
+                    s = state.load (std::memory_order_acquire);
+                }
+            }
+        }
+
+        std::vector<Slice> slices;
+        OwnedArray<Worker> threads;
+
+        std::atomic<bool> active { false };
+        std::atomic<uint32> generation { 0 };
+        std::atomic<int> remaining { 0 };
+        std::atomic<Task> currentTask { nullptr };
+        std::atomic<void*> currentContext { nullptr };
+        uint32 lastGeneration = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkerPool)
+    };
+
+    //==============================================================================
+    /**
+        Compiles render plans on a background thread, so that topology edits never
+        make the message thread or the audio thread wait for a rebuild.
+
+        Only the most recent topology is compiled: snapshots that arrive while a compile
+        is running replace each other.
+    */
+    class RenderEngine::PlanCompiler final : public Thread
+    {
+    public:
+        explicit PlanCompiler (RenderEngine& e)
+            : Thread ("ProcessorGraph plan compiler"), engine (e)
+        {
+            startThread();
+        }
+
+        ~PlanCompiler() override
+        {
+            signalThreadShouldExit();
+            wakeEvent.signal();
+            stopThread (-1);
+        }
+
+        void compile (GraphTopology topology)
+        {
+            {
+                const ScopedLock sl (pendingLock);
+
+                // a snapshot that replaces one still waiting keeps its crossfade
+                if (pendingTopology.has_value())
+                    topology.crossfadeSamples = jmax (topology.crossfadeSamples, pendingTopology->crossfadeSamples);
+
+                pendingTopology = std::move (topology);
+            }
+
+            wakeEvent.signal();
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                wakeEvent.wait (-1);
+
+                std::optional<GraphTopology> topology;
+
+                {
+                    const ScopedLock sl (pendingLock);
+                    std::swap (topology, pendingTopology);
+                }
+
+                if (topology.has_value() && ! threadShouldExit())
+                    engine.compileAndPublish (std::move (*topology));
+            }
+        }
+
+    private:
+        RenderEngine& engine;
+        WaitableEvent wakeEvent;
+        CriticalSection pendingLock;
+        std::optional<GraphTopology> pendingTopology;
+    };
+
+    //==============================================================================
+    RenderEngine::RenderEngine (AudioProcessorGraph& g, const ProcessorGraph::RenderConfig& c, const ConnectionGains& gains)
+        : graph (g), config (c), connectionGains (gains)
+    {
+    }
+
+    RenderEngine::~RenderEngine()
+    {
+        releaseResources();
+    }
+
+    int RenderEngine::getNumWorkerThreads() const
+    {
+        const ScopedLock sl (stateLock);
+        return workers != nullptr ? workers->getNumWorkers() : 0;
+    }
+
+    std::optional<NodeTiming> RenderEngine::getNodeTiming (AudioProcessorGraph::NodeID nodeID) const
+    {
+        if (auto* node = graph.getNodeForId (nodeID))
+            return profiler.getTiming (*node);
+
+        return std::nullopt;
+    }
+
+    std::optional<NodeSleepState> RenderEngine::getNodeSleepState (AudioProcessorGraph::NodeID nodeID) const
+    {
+        if (auto* node = graph.getNodeForId (nodeID))
+            return profiler.getSleepState (*node);
+
+        return std::nullopt;
+    }
+
+    void RenderEngine::resetNodeStatistics()
+    {
+        profiler.reset();
+    }
+
+    //==============================================================================
+    void RenderEngine::prepareToPlay (double sampleRate, int maximumBlockSize)
+    {
+        releaseResources();
+
+        const ScopedLock sl (stateLock);
+
+        currentSampleRate = sampleRate;
+        currentBlockSize = maximumBlockSize;
+
+        hostInput.setSize (jmax (graph.getTotalNumInputChannels(), graph.getTotalNumOutputChannels()), maximumBlockSize);
+        hostMidiIn.ensureSize (4096);
+        hostMidiOut.ensureSize (4096);
+        fadeBuffer.setSize (hostInput.getNumChannels(), maximumBlockSize);
+        fadeView.setDataToReferTo (fadeBuffer.getArrayOfWritePointers(), fadeBuffer.getNumChannels(), maximumBlockSize);
+        fadeMidiOut.ensureSize (4096);
+
+        const auto numWorkers = ! config.enableParallelRendering ? 0
+                              : config.numWorkerThreads < 0 ? jmax (0, SystemStats::getNumCpus() - 1)
+                                                      : config.numWorkerThreads;
+
+        if (numWorkers > 0)
+            workers = std::make_unique<WorkerPool> (numWorkers);
+
+        // the audio callback isn't running yet, so the first plan can be installed directly
+        lastTopology = GraphTopology::capture (graph, &connectionGains);
+        prepareNodes (lastTopology);
+        auto plan = RenderPlan::compile (lastTopology, currentBlockSize, getPlanOptions());
+        attachStatistics (*plan);
+        recordDiagnostics (*plan);
+        activePlan = plan.release();
+
+        if (config.enableBackgroundPlanCompilation)
+            compiler = std::make_unique<PlanCompiler> (*this);
+
+        startTimer (50);
+    }
+
+    void RenderEngine::releaseResources()
+    {
+        stopTimer();
+
+        std::unique_ptr<PlanCompiler> oldCompiler;
+
+        {
+            const ScopedLock sl (stateLock);
+            oldCompiler = std::move (compiler);
+        }
+
+        // the compiler thread doesn't take the lock, but it may still be publishing a plan
+        oldCompiler = nullptr;
+
+        const ScopedLock sl (stateLock);
+
+        // the audio callback has stopped, so every plan can be deleted here
+        delete pendingPlan.exchange (nullptr);
+        delete retiredPlan.exchange (nullptr);
+        delete activePlan;
+        activePlan = nullptr;
+        delete fadingPlan;
+        fadingPlan = nullptr;
+        fadeRemaining = 0;
+
+        {
+            const ScopedLock sl (graveyardLock);
+            graveyard.clear();
+        }
+
+        {
+            const ScopedLock sl (preparedNodesLock);
+
+            for (auto& node : preparedNodes)
+                node->getProcessor()->releaseResources();
+
+            preparedNodes.clear();
+        }
+
+        workers = nullptr;
+        lastTopology = {};
+
+        currentSampleRate = 0.0;
+        currentBlockSize = 0;
+    }
+
+    //==============================================================================
+    void RenderEngine::topologyChanged()
+    {
+        const ScopedLock sl (stateLock);
+
+        if (currentBlockSize <= 0)
+            return;
+
+        auto topology = GraphTopology::capture (graph, &connectionGains);
+
+        if (topology == lastTopology)
+            return;
+
+        // the crossfade belongs to this edit, not to a compile that's already running
+        topology.crossfadeSamples = std::exchange (nextCrossfadeSamples, 0);
+
+        lastTopology = topology;
+        profiler.removeStale (lastTopology.nodes);
+
+        if (compiler != nullptr)
+            compiler->compile (std::move (topology));
+        else
+            compileAndPublish (std::move (topology));
+    }
+
+    void RenderEngine::compileAndPublish (GraphTopology topology)
+    {
+        prepareNodes (topology);
+
+        const auto crossfadeSamples = topology.crossfadeSamples;
+        auto plan = RenderPlan::compile (std::move (topology), currentBlockSize, getPlanOptions());
+        plan->crossfadeSamples = crossfadeSamples;
+        attachStatistics (*plan);
+        recordDiagnostics (*plan);
+        publish (std::move (plan));
+    }
+
+    RenderPlan::Options RenderEngine::getPlanOptions() const
+    {
+        RenderPlan::Options options;
+        options.pruneDeadNodes = config.enableDeadNodePruning;
+        options.foldBypassedNodes = config.enableBypassFolding;
+        options.fuseChains = config.enableChainFusion;
+        options.poolBuffers = config.enableBufferPooling;
+        return options;
+    }
+
+    void RenderEngine::recordDiagnostics (const RenderPlan& plan)
+    {
+        auto diagnostics = plan.getDiagnostics();
+
+        const ScopedLock sl (diagnosticsLock);
+        std::swap (diagnostics, lastDiagnostics);
+    }
+
+    RenderPlanDiagnostics RenderEngine::getPlanDiagnostics() const
+    {
+        const ScopedLock sl (diagnosticsLock);
+        return lastDiagnostics;
+    }
+
+    void RenderEngine::crossfadeToNextPlan (double seconds)
+    {
+        const ScopedLock sl (stateLock);
+        nextCrossfadeSamples = jmax (0, roundToInt (seconds * currentSampleRate));
+    }
+
+    void RenderEngine::adoptPreparedNode (const AudioProcessorGraph::Node::Ptr& node, double sampleRate, int blockSize)
+    {
+        if (node == nullptr || sampleRate != currentSampleRate || blockSize != currentBlockSize)
+            return;
+
+        const ScopedLock sl (preparedNodesLock);
+
+        if (std::find (preparedNodes.begin(), preparedNodes.end(), node) == preparedNodes.end())
+            preparedNodes.push_back (node);
+    }
+
+    void RenderEngine::publish (std::unique_ptr<RenderPlan> plan)
+    {
+        const ScopedLock sl (graveyardLock);
+
+        // make room for the audio thread to retire its current plan
+        if (auto* retired = retiredPlan.exchange (nullptr, std::memory_order_acq_rel))
+            graveyard.emplace_back (retired);
+
+        // a plan that's replaced before the audio thread picked it up was never rendered
+        if (auto* unused = pendingPlan.exchange (plan.release(), std::memory_order_acq_rel))
+            graveyard.emplace_back (unused);
+    }
+
+    void RenderEngine::timerCallback()
+    {
+        // plans and processors are only ever deleted here, on the message thread
+        {
+            const ScopedLock sl (graveyardLock);
+
+            if (auto* retired = retiredPlan.exchange (nullptr, std::memory_order_acq_rel))
+                graveyard.emplace_back (retired);
+
+            graveyard.clear();
+        }
+
+        // bypassing a node doesn't change the graph, but it changes which nodes can be folded
+        if (config.enableBypassFolding)
+        {
+            const ScopedLock sl (stateLock);
+
+            if (lastTopology.bypassStateHasChanged())
+                topologyChanged();
+        }
+
+        const ScopedTryLock sl (preparedNodesLock);
+
+        if (! sl.isLocked())
+            return;
+
+        // once nothing but this list refers to a node, it has left the graph and every live plan
+        for (auto it = preparedNodes.begin(); it != preparedNodes.end();)
+        {
+            if ((*it)->getReferenceCount() == 1)
+            {
+                (*it)->getProcessor()->releaseResources();
+                it = preparedNodes.erase (it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void RenderEngine::prepareNodes (const GraphTopology& topology)
+    {
+        const ScopedLock sl (preparedNodesLock);
+
+        for (auto& node : topology.nodes)
+        {
+            if (std::find (preparedNodes.begin(), preparedNodes.end(), node) != preparedNodes.end())
+                continue;
+
+            auto* processor = node->getProcessor();
+            processor->setRateAndBufferSizeDetails (currentSampleRate, currentBlockSize);
+            processor->prepareToPlay (currentSampleRate, currentBlockSize);
+            preparedNodes.push_back (node);
+        }
+    }
+
+    void RenderEngine::attachStatistics (RenderPlan& plan)
+    {
+        for (auto& op : plan.ops)
+        {
+            if (op.type != RenderPlan::OpType::processor)
+                continue;
+
+            op.statistics = profiler.getStatisticsFor (*op.node);
+
+            for (auto& stage : op.chain)
+                stage.statistics = profiler.getStatisticsFor (*stage.node);
+        }
+    }
+
+    //==============================================================================
+    void RenderEngine::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi)
+    {
+        // a plan that has been faded out is retired as soon as the slot is free
+        if (fadingPlan != nullptr && fadeRemaining <= 0 && retiredPlan.load (std::memory_order_acquire) == nullptr)
+        {
+            retiredPlan.store (fadingPlan, std::memory_order_release);
+            fadingPlan = nullptr;
+        }
+
+        // pick up a newly published plan, unless the previous one is still waiting to be reclaimed
+        if (fadingPlan == nullptr && retiredPlan.load (std::memory_order_acquire) == nullptr)
+        {
+            if (auto* next = pendingPlan.exchange (nullptr, std::memory_order_acq_rel))
+            {
+                if (next->crossfadeSamples > 0 && activePlan != nullptr)
+                {
+                    fadingPlan = activePlan;
+                    fadeLength = fadeRemaining = next->crossfadeSamples;
+                }
+                else
+                {
+                    retiredPlan.store (activePlan, std::memory_order_release);
+                }
+
+                activePlan = next;
+            }
+        }
+
+        if (activePlan == nullptr)
+        {
+            buffer.clear();
+            midi.clear();
+            return;
+        }
+
+        auto& plan = *activePlan;
+        const auto numSamples = buffer.getNumSamples();
+        hostMidiOut.clear();
+
+        for (int start = 0; start < numSamples; start += plan.maximumBlockSize)
+        {
+            const auto numThisTime = jmin (plan.maximumBlockSize, numSamples - start);
+
+            // the host's buffer is only split when it's longer than the block size it prepared
+            // with, and re-pointing a buffer allocates once it has 32 or more channels
+            if (numThisTime < numSamples)
+                hostChunk.setDataToReferTo (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numThisTime);
+
+            auto& chunk = numThisTime < numSamples ? hostChunk : buffer;
+
+            hostMidiIn.clear();
+            hostMidiIn.addEvents (midi, start, numThisTime, -start);
+
+            if (fadeRemaining > 0)
+                renderCrossfade (plan, chunk, start);
+            else
+                renderBlock (plan, chunk, hostMidiIn, hostMidiOut, start);
+        }
+
+        midi.swapWith (hostMidiOut);
+    }
+
+    void RenderEngine::renderCrossfade (RenderPlan& plan, AudioBuffer<float>& io, int midiOutOffset)
+    {
+        const auto numSamples = io.getNumSamples();
+        const auto numChannels = jmin (io.getNumChannels(), fadeBuffer.getNumChannels());
+
+        // both plans render the same input; only the new one's MIDI output is kept
+        if (fadeView.getNumChannels() != numChannels || fadeView.getNumSamples() != numSamples)
+            fadeView.setDataToReferTo (fadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+        auto& fadeOut = fadeView;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            fadeOut.copyFrom (ch, 0, io, ch, 0, numSamples);
+
+        fadeMidiOut.clear();
+        renderBlock (*fadingPlan, fadeOut, hostMidiIn, fadeMidiOut, 0);
+        renderBlock (plan, io, hostMidiIn, hostMidiOut, midiOutOffset);
+
+        const auto numFading = jmin (numSamples, fadeRemaining);
+        const auto startGain = 1.0f - (float) fadeRemaining / (float) fadeLength;
+        const auto endGain = 1.0f - (float) (fadeRemaining - numFading) / (float) fadeLength;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            io.applyGainRamp (ch, 0, numFading, startGain, endGain);
+            io.addFromWithRamp (ch, 0, fadeOut.getReadPointer (ch), numFading, 1.0f - startGain, 1.0f - endGain);
+        }
+
+        fadeRemaining -= numFading;
+    }
+
+    void RenderEngine::renderBlock (RenderPlan& plan, AudioBuffer<float>& io, const MidiBuffer& midiIn, MidiBuffer& midiOut, int midiOutOffset)
+    {
+        const auto numSamples = io.getNumSamples();
+
+        hostInput.setSize (hostInput.getNumChannels(), numSamples, false, false, true);
+
+        for (int ch = 0; ch < jmin (io.getNumChannels(), hostInput.getNumChannels()); ++ch)
+            hostInput.copyFrom (ch, 0, io, ch, 0, numSamples);
+
+        currentMidiIn = &midiIn;
+        currentPlayHead = graph.getPlayHead();
+
+        const auto useWorkers = workers != nullptr
+                                && plan.maxLevelWidth > 1
+                                && (int) plan.ops.size() >= config.serialProcessingThreshold;
+
+        if (useWorkers)
+            workers->beginBlock();
+
+        for (int level = 0; level < plan.getNumLevels(); ++level)
+        {
+            const auto firstOp = plan.levelStarts[(size_t) level];
+            const auto numOps = plan.levelStarts[(size_t) level + 1] - firstOp;
+
+            if (! useWorkers || numOps == 1)
+            {
+                for (int i = firstOp; i < firstOp + numOps; ++i)
+                    renderOp (plan, plan.ops[(size_t) i], numSamples);
+
+                continue;
+            }
+
+            levelContext = { this, &plan, firstOp, numSamples };
+            workers->run (numOps, renderOpTask, &levelContext);
+        }
+
+        if (useWorkers)
+            workers->endBlock();
+
+        io.clear();
+
+        for (auto& op : plan.ops)
+        {
+            if (op.type == RenderPlan::OpType::audioOutput)
+            {
+                for (int ch = 0; ch < jmin (op.numChannels, io.getNumChannels()); ++ch)
+                    io.addFrom (ch, 0, op.buffer, ch, 0, numSamples);
+            }
+            else if (op.type == RenderPlan::OpType::midiOutput)
+            {
+                midiOut.addEvents (op.midi, 0, numSamples, midiOutOffset);
+            }
+        }
+    }
+
+    bool RenderEngine::isSilent (const AudioBuffer<float>& buffer, int numSamples)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            if (buffer.getMagnitude (ch, 0, numSamples) > silenceThreshold)
+                return false;
+
+        return true;
+    }
+
+    void RenderEngine::renderOpTask (void* context, int index)
+    {
+        auto& ctx = *static_cast<LevelContext*> (context);
+        ctx.engine->renderOp (*ctx.plan, ctx.plan->ops[(size_t) (ctx.firstOp + index)], ctx.numSamples);
+    }
+
+    void RenderEngine::renderOp (RenderPlan& plan, RenderPlan::Op& op, int numSamples)
+    {
+        if (op.view.getNumSamples() != numSamples)
+            op.view.setDataToReferTo (op.buffer.getArrayOfWritePointers(), op.numChannels, numSamples);
+
+        auto& buffer = op.view;
+
+        for (size_t i = 0; i < op.audioSources.size(); ++i)
+            if (auto* gain = op.audioSources[i].gain)
+                op.sourceGains[i] = gain->load (std::memory_order_relaxed);
+
+        // an in-place channel already holds its source's output
+        for (int ch = 0; ch < op.numChannels; ++ch)
+        {
+            if (op.inPlaceChannels[(size_t) ch])
+                continue;
+
+            const auto first = op.channelSourceStarts[(size_t) ch];
+            const auto numSources = op.channelSourceStarts[(size_t) ch + 1] - first;
+
+            FanInKernel::mix (buffer.getWritePointer (ch),
+                              op.sourceChannels.data() + first,
+                              op.sourceGains.data() + first,
+                              numSources,
+                              numSamples);
+        }
+
+        op.midi.clear();
+
+        for (auto source : op.midiSources)
+            op.midi.addEvents (plan.ops[(size_t) source].midi, 0, numSamples, 0);
+
+        switch (op.type)
+        {
+            case RenderPlan::OpType::audioInput:
+                for (int ch = 0; ch < jmin (op.numChannels, hostInput.getNumChannels()); ++ch)
+                    buffer.copyFrom (ch, 0, hostInput, ch, 0, numSamples);
+                break;
+
+            case RenderPlan::OpType::midiInput:
+                op.midi.addEvents (*currentMidiIn, 0, numSamples, 0);
+                break;
+
+            case RenderPlan::OpType::audioOutput:
+            case RenderPlan::OpType::midiOutput:
+                break;
+
+            case RenderPlan::OpType::processor:
+                renderProcessor (*op.node, *op.processor, *op.statistics, buffer, op.midi, numSamples);
+
+                // fused nodes process the buffer in place, as if it had been copied to them
+                for (auto& stage : op.chain)
+                {
+                    for (int ch = stage.firstClearedChannel; ch < buffer.getNumChannels(); ++ch)
+                        buffer.clear (ch, 0, numSamples);
+
+                    if (! stage.keepsMidi)
+                        op.midi.clear();
+
+                    renderProcessor (*stage.node, *stage.processor, *stage.statistics, buffer, op.midi, numSamples);
+                }
+
+                break;
+        }
+    }
+
+    void RenderEngine::renderProcessor (AudioProcessorGraph::Node& node, AudioProcessor& processor, NodeProfiler::Entry& stats,
+                                        AudioBuffer<float>& buffer, MidiBuffer& midi, int numSamples)
+    {
+        const auto inputIsSilent = config.enableSilenceSleeping
+                                   && (processor.getTotalNumInputChannels() > 0 || processor.acceptsMidi())
+                                   && midi.isEmpty()
+                                   && isSilent (buffer, numSamples);
+
+        if (! inputIsSilent)
+        {
+            stats.numSilentSamples = 0;
+            stats.isAsleep = false;
+        }
+        else if (stats.isAsleep)
+        {
+            // the buffer only holds silent input, which is what a sleeping node passes on
+            buffer.clear();
+            stats.sleep.record (true);
+            return;
+        }
+
+        processor.setPlayHead (currentPlayHead);
+
+        {
+            const ScopedLock sl (processor.getCallbackLock());
+
+           #if PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING
+            const auto startTicks = Time::getHighResolutionTicks();
+           #endif
+
+            if (processor.isSuspended())
+                buffer.clear();
+            else if (node.isBypassed() && processor.getBypassParameter() == nullptr)
+                processor.processBlockBypassed (buffer, midi);
+            else
+                processor.processBlock (buffer, midi);
+
+           #if PLAYFULTONES_PROCESSORGRAPH_ENABLE_PROFILING
+            stats.timing.record (Time::getHighResolutionTicks() - startTicks, numSamples, currentSampleRate);
+           #endif
+        }
+
+        if (config.enableSilenceSleeping)
+        {
+            if (inputIsSilent)
+            {
+                // sleep once the tail has run out and the node has gone quiet too,
+                // so that self-oscillating or generating nodes keep running
+                stats.numSilentSamples += numSamples;
+                const auto tailSeconds = processor.getTailLengthSeconds();
+
+                stats.isAsleep = std::isfinite (tailSeconds)
+                                 && (double) stats.numSilentSamples >= tailSeconds * currentSampleRate
+                                 && midi.isEmpty()
+                                 && isSilent (buffer, numSamples);
+            }
+
+            stats.sleep.record (false);
+        }
+    }
+} // namespace PlayfulTones
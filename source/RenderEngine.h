@@ -0,0 +1,150 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /**
+        Renders the nodes of an AudioProcessorGraph from a RenderPlan, processing the
+        independent nodes of each dependency level on a pool of real-time worker threads.
+
+        This replaces AudioProcessorGraph's own rendering when
+        enableParallelRendering or enableSilenceSleeping is set in the RenderConfig. It prepares
+        the node processors itself, so the wrapped graph doesn't need to be prepared.
+        Plugin delay compensation is not applied.
+
+        Connections that land on the same input channel are summed, with their gains, by
+        FanInKernel.
+
+        Nodes that can't be heard are left out of the plan, and bypassed nodes that only pass
+        their input through are replaced by wiring their inputs to the nodes they feed. A
+        bypass change is noticed by a timer, or straight away with ProcessorGraph::setNodeBypassed().
+
+        With ProcessorGraph::RenderConfig::enableSilenceSleeping, a node whose inputs have
+        been silent for longer than its tail stops being processed until sound or MIDI
+        reaches it again.
+
+        New plans are handed to the audio thread through an atomic pointer, and the
+        plans it retires are deleted on the message thread, so an edit never blocks or
+        allocates inside processBlock().
+    */
+    class RenderEngine final : private Timer
+    {
+    public:
+        RenderEngine (AudioProcessorGraph& graph, const ProcessorGraph::RenderConfig& config, const ConnectionGains& gains);
+        ~RenderEngine() override;
+
+        //==============================================================================
+        void prepareToPlay (double sampleRate, int maximumBlockSize);
+        void releaseResources();
+        void processBlock (AudioBuffer<float>&, MidiBuffer&);
+
+        /** Schedules a new render plan if the graph's topology has changed.
+            Must be called on the message thread.
+        */
+        void topologyChanged();
+
+        [[nodiscard]] int getNumWorkerThreads() const;
+        [[nodiscard]] double getSampleRate() const noexcept    { return currentSampleRate.load(); }
+        [[nodiscard]] int getBlockSize() const noexcept        { return currentBlockSize.load(); }
+
+        /** Makes the plan for the next topology change crossfade in from the current one.
+            Must be called on the message thread.
+        */
+        void crossfadeToNextPlan (double seconds);
+
+        /** Takes over a node whose processor was already prepared, e.g. on a loading thread,
+            so that it isn't prepared again. Ignored if the settings don't match the engine's.
+        */
+        void adoptPreparedNode (const AudioProcessorGraph::Node::Ptr&, double sampleRate, int blockSize);
+
+        [[nodiscard]] std::optional<NodeTiming> getNodeTiming (AudioProcessorGraph::NodeID) const;
+        [[nodiscard]] std::optional<NodeSleepState> getNodeSleepState (AudioProcessorGraph::NodeID) const;
+        void resetNodeStatistics();
+
+        /** Returns the nodes the most recently compiled plan pruned, folded or fused. */
+        [[nodiscard]] RenderPlanDiagnostics getPlanDiagnostics() const;
+
+    private:
+        //==============================================================================
+        class WorkerPool;
+        class PlanCompiler;
+
+        void renderBlock (RenderPlan&, AudioBuffer<float>&, const MidiBuffer& midiIn, MidiBuffer& midiOut, int midiOutOffset);
+        void renderCrossfade (RenderPlan&, AudioBuffer<float>&, int midiOutOffset);
+        void renderOp (RenderPlan&, RenderPlan::Op&, int numSamples);
+        void renderProcessor (AudioProcessorGraph::Node&, AudioProcessor&, NodeProfiler::Entry&,
+                              AudioBuffer<float>&, MidiBuffer&, int numSamples);
+        static void renderOpTask (void* context, int index);
+        static bool isSilent (const AudioBuffer<float>&, int numSamples);
+
+        // about -120 dBFS
+        static constexpr float silenceThreshold = 1.0e-6f;
+
+        void compileAndPublish (GraphTopology);
+        void publish (std::unique_ptr<RenderPlan>);
+        void prepareNodes (const GraphTopology&);
+        void attachStatistics (RenderPlan&);
+        void recordDiagnostics (const RenderPlan&);
+        [[nodiscard]] RenderPlan::Options getPlanOptions() const;
+        void timerCallback() override;
+
+        AudioProcessorGraph& graph;
+        const ProcessorGraph::RenderConfig config;
+        const ConnectionGains& connectionGains;
+
+        // set by the host's thread, read by the message thread and the plan compiler
+        std::atomic<double> currentSampleRate { 0.0 };
+        std::atomic<int> currentBlockSize { 0 };
+
+        // held by prepareToPlay() and releaseResources(), which the host may call on its own
+        // thread, and by the message thread whenever it reads or replaces the members below
+        CriticalSection stateLock;
+
+        // written by the publisher, taken by the audio thread
+        std::atomic<RenderPlan*> pendingPlan { nullptr };
+        // written by the audio thread, reclaimed on the message thread
+        std::atomic<RenderPlan*> retiredPlan { nullptr };
+        // only touched by the audio thread while it's running
+        RenderPlan* activePlan = nullptr;
+        RenderPlan* fadingPlan = nullptr;
+        int fadeLength = 0, fadeRemaining = 0;
+
+        GraphTopology lastTopology;
+        int nextCrossfadeSamples = 0;
+        std::unique_ptr<PlanCompiler> compiler;
+
+        CriticalSection graveyardLock;
+        std::vector<std::unique_ptr<RenderPlan>> graveyard;
+
+        CriticalSection preparedNodesLock;
+        std::vector<AudioProcessorGraph::Node::Ptr> preparedNodes;
+
+        CriticalSection diagnosticsLock;
+        RenderPlanDiagnostics lastDiagnostics;
+
+        std::unique_ptr<WorkerPool> workers;
+        NodeProfiler profiler;
+
+        AudioBuffer<float> hostInput, hostChunk;
+        MidiBuffer hostMidiIn, hostMidiOut;
+        AudioBuffer<float> fadeBuffer, fadeView;
+        MidiBuffer fadeMidiOut;
+        const MidiBuffer* currentMidiIn = nullptr;
+        AudioPlayHead* currentPlayHead = nullptr;
+
+        struct LevelContext
+        {
+            RenderEngine* engine = nullptr;
+            RenderPlan* plan = nullptr;
+            int firstOp = 0;
+            int numSamples = 0;
+        };
+
+        LevelContext levelContext;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderEngine)
+    };
+} // namespace PlayfulTones
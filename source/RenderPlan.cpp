@@ -0,0 +1,673 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+namespace PlayfulTones {
+    bool ConnectionGains::set (const AudioProcessorGraph::Connection& connection, float gain)
+    {
+        if (auto it = gains.find (connection); it != gains.end())
+        {
+            it->second->store (gain, std::memory_order_relaxed);
+            return false;
+        }
+
+        gains.emplace (connection, std::make_shared<std::atomic<float>> (gain));
+        return true;
+    }
+
+    float ConnectionGains::get (const AudioProcessorGraph::Connection& connection) const
+    {
+        const auto it = gains.find (connection);
+        return it != gains.end() ? it->second->load (std::memory_order_relaxed) : 1.0f;
+    }
+
+    std::shared_ptr<const std::atomic<float>> ConnectionGains::find (const AudioProcessorGraph::Connection& connection) const
+    {
+        const auto it = gains.find (connection);
+        return it != gains.end() ? it->second : nullptr;
+    }
+
+    void ConnectionGains::remove (const AudioProcessorGraph::Connection& connection)
+    {
+        gains.erase (connection);
+    }
+
+    void ConnectionGains::removeStale (const AudioProcessorGraph& graph)
+    {
+        for (auto it = gains.begin(); it != gains.end();)
+        {
+            if (graph.isConnected (it->first))
+                ++it;
+            else
+                it = gains.erase (it);
+        }
+    }
+
+    //==============================================================================
+    GraphTopology GraphTopology::capture (const AudioProcessorGraph& graph, const ConnectionGains* connectionGains)
+    {
+        GraphTopology topology;
+
+        for (auto* node : graph.getNodes())
+        {
+            topology.nodes.emplace_back (node);
+            topology.bypassed.push_back (node->isBypassed());
+        }
+
+        topology.connections = graph.getConnections();
+
+        if (connectionGains != nullptr && ! connectionGains->isEmpty())
+            for (const auto& c : topology.connections)
+                topology.gains.push_back (connectionGains->find (c));
+
+        return topology;
+    }
+
+    bool GraphTopology::operator== (const GraphTopology& other) const
+    {
+        return nodes == other.nodes && connections == other.connections && bypassed == other.bypassed && gains == other.gains;
+    }
+
+    bool GraphTopology::bypassStateHasChanged() const
+    {
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (nodes[i]->isBypassed() != bypassed[i])
+                return true;
+
+        return false;
+    }
+
+    //==============================================================================
+    static RenderPlan::OpType getOpType (AudioProcessor* processor)
+    {
+        using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+
+        if (auto* io = dynamic_cast<IOProcessor*> (processor))
+        {
+            switch (io->getType())
+            {
+                case IOProcessor::audioInputNode:   return RenderPlan::OpType::audioInput;
+                case IOProcessor::audioOutputNode:  return RenderPlan::OpType::audioOutput;
+                case IOProcessor::midiInputNode:    return RenderPlan::OpType::midiInput;
+                case IOProcessor::midiOutputNode:   return RenderPlan::OpType::midiOutput;
+                default:                            break;
+            }
+        }
+
+        return RenderPlan::OpType::processor;
+    }
+
+    /** True for nodes that are processed for their own sake: outputs, and nodes that produce nothing, like meters. */
+    static bool isSink (RenderPlan::OpType type, AudioProcessor& processor)
+    {
+        if (type == RenderPlan::OpType::audioOutput || type == RenderPlan::OpType::midiOutput)
+            return true;
+
+        return type == RenderPlan::OpType::processor
+               && processor.getTotalNumOutputChannels() == 0
+               && ! processor.producesMidi();
+    }
+
+    // Gives every op channel a channel of the plan's buffer pool. A channel is live from the level its
+    // op is rendered at until the last level that reads it, and since the ops within a level run
+    // concurrently, two channels can only share a pool channel if their lifetimes have no level in
+    // common. Assigning them by start level, each to any pool channel that's free by then, needs no
+    // more pool channels than there are channels live at the busiest level.
+    static void allocateBuffers (RenderPlan& plan, int blockSize, bool shouldPool)
+    {
+        const auto numOps = plan.ops.size();
+
+        std::vector<int> firstChannels (numOps);
+        int numChannels = 0;
+
+        for (size_t i = 0; i < numOps; ++i)
+        {
+            firstChannels[i] = numChannels;
+            numChannels += plan.ops[i].numChannels;
+        }
+
+        std::vector<int> starts ((size_t) numChannels), ends ((size_t) numChannels);
+        std::vector<int> numReaders ((size_t) numChannels, 0), numWriters ((size_t) numChannels, 0);
+
+        for (size_t i = 0; i < numOps; ++i)
+        {
+            const auto& op = plan.ops[i];
+
+            // outputs are read after the last level has been rendered
+            for (int ch = 0; ch < op.numChannels; ++ch)
+            {
+                starts[(size_t) (firstChannels[i] + ch)] = op.level;
+                ends[(size_t) (firstChannels[i] + ch)] = op.type == RenderPlan::OpType::audioOutput ? plan.getNumLevels() : op.level;
+            }
+        }
+
+        for (size_t i = 0; i < numOps; ++i)
+        {
+            for (const auto& source : plan.ops[i].audioSources)
+            {
+                const auto src = (size_t) (firstChannels[(size_t) source.op] + source.channel);
+                ends[src] = jmax (ends[src], plan.ops[i].level);
+                ++numReaders[src];
+                ++numWriters[(size_t) (firstChannels[i] + source.destChannel)];
+            }
+        }
+
+        // a channel with a single source that has no other reader takes over the source's pool channel;
+        // ops are in level order, so the source has been merged with its own source already
+        std::vector<int> roots ((size_t) numChannels);
+        for (int ch = 0; ch < numChannels; ++ch)
+            roots[(size_t) ch] = ch;
+
+        for (size_t i = 0; i < numOps; ++i)
+        {
+            auto& op = plan.ops[i];
+            op.inPlaceChannels.assign ((size_t) op.numChannels, false);
+
+            if (! shouldPool)
+                continue;
+
+            for (auto& source : op.audioSources)
+            {
+                const auto src = (size_t) (firstChannels[(size_t) source.op] + source.channel);
+                const auto dst = (size_t) (firstChannels[i] + source.destChannel);
+
+                if (numReaders[src] == 1 && numWriters[dst] == 1 && source.gain == nullptr)
+                {
+                    source.isInPlace = true;
+                    op.inPlaceChannels[(size_t) source.destChannel] = true;
+                    roots[dst] = roots[src];
+
+                    starts[(size_t) roots[dst]] = jmin (starts[(size_t) roots[dst]], starts[dst]);
+                    ends[(size_t) roots[dst]] = jmax (ends[(size_t) roots[dst]], ends[dst]);
+                    ++plan.numInPlaceChannels;
+                }
+            }
+        }
+
+        std::vector<int> order;
+        for (int ch = 0; ch < numChannels; ++ch)
+            if (roots[(size_t) ch] == ch)
+                order.push_back (ch);
+
+        std::stable_sort (order.begin(), order.end(), [&starts] (int a, int b) { return starts[(size_t) a] < starts[(size_t) b]; });
+
+        std::vector<int> poolChannels ((size_t) numChannels, -1);
+        int numPoolChannels = 0;
+
+        if (shouldPool)
+        {
+            // the pool channels in use, soonest free first
+            std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> inUse;
+            std::vector<int> freeChannels;
+
+            for (auto ch : order)
+            {
+                while (! inUse.empty() && inUse.top().first < starts[(size_t) ch])
+                {
+                    freeChannels.push_back (inUse.top().second);
+                    inUse.pop();
+                }
+
+                if (freeChannels.empty())
+                {
+                    poolChannels[(size_t) ch] = numPoolChannels++;
+                }
+                else
+                {
+                    poolChannels[(size_t) ch] = freeChannels.back();
+                    freeChannels.pop_back();
+                }
+
+                inUse.push ({ ends[(size_t) ch], poolChannels[(size_t) ch] });
+            }
+        }
+        else
+        {
+            for (auto ch : order)
+                poolChannels[(size_t) ch] = numPoolChannels++;
+        }
+
+        plan.bufferPool.setSize (numPoolChannels, blockSize);
+        plan.bufferPool.clear();
+        plan.numUnpooledBufferChannels = numChannels;
+
+        std::vector<float*> channels;
+
+        for (size_t i = 0; i < numOps; ++i)
+        {
+            auto& op = plan.ops[i];
+
+            if (op.numChannels == 0)
+                continue;
+
+            channels.clear();
+
+            for (int ch = 0; ch < op.numChannels; ++ch)
+                channels.push_back (plan.bufferPool.getWritePointer (poolChannels[(size_t) roots[(size_t) (firstChannels[i] + ch)]]));
+
+            op.buffer.setDataToReferTo (channels.data(), op.numChannels, blockSize);
+            op.view.setDataToReferTo (op.buffer.getArrayOfWritePointers(), op.numChannels, blockSize);
+        }
+
+        // with the channels fixed, the audio thread only needs to read the gains
+        for (auto& op : plan.ops)
+        {
+            op.channelSourceStarts.assign ((size_t) op.numChannels + 1, 0);
+
+            for (const auto& source : op.audioSources)
+            {
+                op.sourceChannels.push_back (plan.ops[(size_t) source.op].buffer.getReadPointer (source.channel));
+                ++op.channelSourceStarts[(size_t) source.destChannel + 1];
+            }
+
+            for (size_t ch = 1; ch < op.channelSourceStarts.size(); ++ch)
+                op.channelSourceStarts[ch] += op.channelSourceStarts[ch - 1];
+
+            op.sourceGains.assign (op.audioSources.size(), 1.0f);
+        }
+    }
+
+    std::unique_ptr<RenderPlan> RenderPlan::compile (GraphTopology topology, int blockSize, const Options& options)
+    {
+        auto plan = std::make_unique<RenderPlan>();
+        plan->maximumBlockSize = blockSize;
+
+        const auto numNodes = (int) topology.nodes.size();
+
+        std::unordered_map<uint32, int> nodeIndices;
+        for (int i = 0; i < numNodes; ++i)
+            nodeIndices[topology.nodes[(size_t) i]->nodeID.uid] = i;
+
+        const auto findNode = [&nodeIndices] (AudioProcessorGraph::NodeID nodeID)
+        {
+            const auto it = nodeIndices.find (nodeID.uid);
+            return it != nodeIndices.end() ? it->second : -1;
+        };
+
+        std::vector<OpType> types ((size_t) numNodes);
+        std::vector<int> numChannels ((size_t) numNodes);
+
+        for (int i = 0; i < numNodes; ++i)
+        {
+            auto* processor = topology.nodes[(size_t) i]->getProcessor();
+            types[(size_t) i] = getOpType (processor);
+            numChannels[(size_t) i] = jmax (processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+        }
+
+        // the valid connections arriving at each node
+        struct Input
+        {
+            int node;
+            int channel;
+            int destChannel;
+            const std::atomic<float>* gain;
+        };
+
+        std::vector<std::vector<Input>> audioInputs ((size_t) numNodes);
+        std::vector<std::vector<int>> midiInputs ((size_t) numNodes);
+
+        // a node with gains on its connections can't be folded, as gains along a path would have to be multiplied
+        std::vector<bool> hasGains ((size_t) numNodes, false);
+
+        for (size_t i = 0; i < topology.connections.size(); ++i)
+        {
+            const auto& c = topology.connections[i];
+            const auto src = findNode (c.source.nodeID);
+            const auto dst = findNode (c.destination.nodeID);
+
+            if (src < 0 || dst < 0)
+                continue;
+
+            const auto* gain = i < topology.gains.size() ? topology.gains[i].get() : nullptr;
+
+            if (c.source.isMIDI() && c.destination.isMIDI())
+            {
+                midiInputs[(size_t) dst].push_back (src);
+            }
+            else if (isPositiveAndBelow (c.source.channelIndex, numChannels[(size_t) src])
+                     && isPositiveAndBelow (c.destination.channelIndex, numChannels[(size_t) dst]))
+            {
+                audioInputs[(size_t) dst].push_back ({ src, c.source.channelIndex, c.destination.channelIndex, gain });
+
+                if (gain != nullptr)
+                    hasGains[(size_t) src] = hasGains[(size_t) dst] = true;
+            }
+        }
+
+        // walk back from the sinks to find the nodes that can be heard
+        std::vector<bool> isLive ((size_t) numNodes, ! options.pruneDeadNodes);
+
+        if (options.pruneDeadNodes)
+        {
+            std::vector<int> toVisit;
+
+            for (int i = 0; i < numNodes; ++i)
+            {
+                if (isSink (types[(size_t) i], *topology.nodes[(size_t) i]->getProcessor()))
+                {
+                    isLive[(size_t) i] = true;
+                    toVisit.push_back (i);
+                }
+            }
+
+            const auto visit = [&] (int n)
+            {
+                if (! isLive[(size_t) n])
+                {
+                    isLive[(size_t) n] = true;
+                    toVisit.push_back (n);
+                }
+            };
+
+            while (! toVisit.empty())
+            {
+                const auto n = toVisit.back();
+                toVisit.pop_back();
+
+                for (const auto& input : audioInputs[(size_t) n])
+                    visit (input.node);
+
+                for (auto src : midiInputs[(size_t) n])
+                    visit (src);
+            }
+        }
+
+        // a bypassed node without a bypass parameter only passes its input through, so its
+        // consumers can read from its sources directly
+        std::vector<bool> isFolded ((size_t) numNodes, false);
+
+        if (options.foldBypassedNodes)
+        {
+            for (int i = 0; i < numNodes; ++i)
+            {
+                const auto& node = topology.nodes[(size_t) i];
+                auto* processor = node->getProcessor();
+
+                isFolded[(size_t) i] = isLive[(size_t) i]
+                                       && types[(size_t) i] == OpType::processor
+                                       && ! hasGains[(size_t) i]
+                                       && i < (int) topology.bypassed.size() && topology.bypassed[(size_t) i]
+                                       && processor->getBypassParameter() == nullptr
+                                       && processor->getTotalNumInputChannels() == processor->getTotalNumOutputChannels();
+            }
+        }
+
+        // the unfolded nodes each input really comes from, following chains of folded nodes
+        std::function<void (const Input&, std::vector<Input>&)> resolveAudio = [&] (const Input& input, std::vector<Input>& result)
+        {
+            if (! isFolded[(size_t) input.node])
+            {
+                result.push_back (input);
+                return;
+            }
+
+            for (const auto& folded : audioInputs[(size_t) input.node])
+                if (folded.destChannel == input.channel)
+                    resolveAudio ({ folded.node, folded.channel, input.destChannel, nullptr }, result);
+        };
+
+        std::function<void (int, std::vector<int>&)> resolveMidi = [&] (int src, std::vector<int>& result)
+        {
+            if (! isFolded[(size_t) src])
+            {
+                result.push_back (src);
+                return;
+            }
+
+            for (auto input : midiInputs[(size_t) src])
+                resolveMidi (input, result);
+        };
+
+        std::vector<std::vector<Input>> resolvedAudio ((size_t) numNodes);
+        std::vector<std::vector<int>> resolvedMidi ((size_t) numNodes);
+        std::vector<bool> isScheduled ((size_t) numNodes, false);
+
+        for (int i = 0; i < numNodes; ++i)
+        {
+            const auto& node = topology.nodes[(size_t) i];
+
+            if (! isLive[(size_t) i])
+            {
+                plan->prunedNodes.push_back (node->nodeID);
+                continue;
+            }
+
+            if (isFolded[(size_t) i])
+            {
+                plan->foldedNodes.push_back (node->nodeID);
+                continue;
+            }
+
+            isScheduled[(size_t) i] = true;
+
+            for (const auto& input : audioInputs[(size_t) i])
+                resolveAudio (input, resolvedAudio[(size_t) i]);
+
+            for (auto src : midiInputs[(size_t) i])
+                resolveMidi (src, resolvedMidi[(size_t) i]);
+        }
+
+        // a node whose only consumer is a node it's the only producer for, with every output channel
+        // going to the same input channel, can hand that consumer its buffer as it is
+        std::vector<int> nextInChain ((size_t) numNodes, -1), previousInChain ((size_t) numNodes, -1);
+
+        if (options.fuseChains)
+        {
+            std::vector<std::vector<int>> consumers ((size_t) numNodes);
+
+            for (int i = 0; i < numNodes; ++i)
+            {
+                for (const auto& input : resolvedAudio[(size_t) i])
+                    consumers[(size_t) input.node].push_back (i);
+
+                for (auto src : resolvedMidi[(size_t) i])
+                    consumers[(size_t) src].push_back (i);
+            }
+
+            const auto canFuse = [&] (int src, int dst)
+            {
+                auto* srcProcessor = topology.nodes[(size_t) src]->getProcessor();
+                auto* dstProcessor = topology.nodes[(size_t) dst]->getProcessor();
+                const auto numOutputs = srcProcessor->getTotalNumOutputChannels();
+
+                if (types[(size_t) src] != OpType::processor || types[(size_t) dst] != OpType::processor
+                    || numChannels[(size_t) src] != numChannels[(size_t) dst]
+                    || numOutputs != dstProcessor->getTotalNumInputChannels()
+                    || (int) resolvedAudio[(size_t) dst].size() != numOutputs
+                    || resolvedMidi[(size_t) dst].size() > 1)
+                    return false;
+
+                for (auto consumer : consumers[(size_t) src])
+                    if (consumer != dst)
+                        return false;
+
+                for (auto midiSource : resolvedMidi[(size_t) dst])
+                    if (midiSource != src)
+                        return false;
+
+                std::vector<bool> isConnected ((size_t) numOutputs, false);
+
+                for (const auto& input : resolvedAudio[(size_t) dst])
+                {
+                    if (input.node != src || input.channel != input.destChannel || input.gain != nullptr || isConnected[(size_t) input.channel])
+                        return false;
+
+                    isConnected[(size_t) input.channel] = true;
+                }
+
+                return true;
+            };
+
+            for (int i = 0; i < numNodes; ++i)
+            {
+                if (! isScheduled[(size_t) i] || consumers[(size_t) i].empty())
+                    continue;
+
+                const auto next = consumers[(size_t) i].front();
+
+                if (canFuse (i, next))
+                {
+                    nextInChain[(size_t) i] = next;
+                    previousInChain[(size_t) next] = i;
+                }
+            }
+        }
+
+        // every node is scheduled as the op of the chain it heads. A chain's members are only
+        // assigned while walking from its head, as they're unscheduled along the way
+        std::vector<int> chainHeads ((size_t) numNodes);
+
+        for (int i = 0; i < numNodes; ++i)
+            chainHeads[(size_t) i] = i;
+
+        for (int i = 0; i < numNodes; ++i)
+        {
+            if (! isScheduled[(size_t) i] || previousInChain[(size_t) i] >= 0 || nextInChain[(size_t) i] < 0)
+                continue;
+
+            std::vector<AudioProcessorGraph::NodeID> chain;
+
+            for (auto n = i; n >= 0; n = nextInChain[(size_t) n])
+            {
+                chainHeads[(size_t) n] = i;
+                chain.push_back (topology.nodes[(size_t) n]->nodeID);
+
+                if (n != i)
+                    isScheduled[(size_t) n] = false;
+            }
+
+            plan->fusedChains.push_back (std::move (chain));
+        }
+
+        for (int i = 0; i < numNodes; ++i)
+        {
+            if (! isScheduled[(size_t) i])
+                continue;
+
+            for (auto& input : resolvedAudio[(size_t) i])
+                input.node = chainHeads[(size_t) input.node];
+
+            for (auto& src : resolvedMidi[(size_t) i])
+                src = chainHeads[(size_t) src];
+        }
+
+        // Kahn's algorithm, assigning every node the length of the longest path leading to it
+        std::vector<std::vector<int>> successors ((size_t) numNodes);
+        std::vector<int> numPendingInputs ((size_t) numNodes, 0);
+        std::vector<int> levels ((size_t) numNodes, 0);
+
+        const auto addEdge = [&] (int src, int dst)
+        {
+            successors[(size_t) src].push_back (dst);
+            ++numPendingInputs[(size_t) dst];
+        };
+
+        for (int i = 0; i < numNodes; ++i)
+        {
+            if (! isScheduled[(size_t) i])
+                continue;
+
+            for (const auto& input : resolvedAudio[(size_t) i])
+                addEdge (input.node, i);
+
+            for (auto src : resolvedMidi[(size_t) i])
+                addEdge (src, i);
+        }
+
+        std::vector<int> order;
+        order.reserve ((size_t) numNodes);
+
+        for (int i = 0; i < numNodes; ++i)
+            if (isScheduled[(size_t) i] && numPendingInputs[(size_t) i] == 0)
+                order.push_back (i);
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const auto n = order[i];
+
+            for (auto next : successors[(size_t) n])
+            {
+                levels[(size_t) next] = jmax (levels[(size_t) next], levels[(size_t) n] + 1);
+
+                if (--numPendingInputs[(size_t) next] == 0)
+                    order.push_back (next);
+            }
+        }
+
+        // AudioProcessorGraph refuses to create feedback loops, so every node must have been scheduled
+        jassert ((int) order.size() == (int) std::count (isScheduled.begin(), isScheduled.end(), true));
+
+        std::stable_sort (order.begin(), order.end(), [&levels] (int a, int b) { return levels[(size_t) a] < levels[(size_t) b]; });
+
+        std::vector<int> opIndices ((size_t) numNodes, -1);
+        plan->ops.resize (order.size());
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const auto n = order[i];
+            auto& op = plan->ops[i];
+
+            op.node = topology.nodes[(size_t) n];
+            op.processor = op.node->getProcessor();
+            op.type = types[(size_t) n];
+            op.level = levels[(size_t) n];
+            op.numChannels = numChannels[(size_t) n];
+
+            for (auto prev = n, next = nextInChain[(size_t) n]; next >= 0; prev = next, next = nextInChain[(size_t) next])
+            {
+                RenderPlan::Stage stage;
+                stage.node = topology.nodes[(size_t) next];
+                stage.processor = stage.node->getProcessor();
+                stage.firstClearedChannel = topology.nodes[(size_t) prev]->getProcessor()->getTotalNumOutputChannels();
+                stage.keepsMidi = ! resolvedMidi[(size_t) next].empty();
+                op.chain.push_back (std::move (stage));
+            }
+
+            opIndices[(size_t) n] = (int) i;
+        }
+
+        for (auto n : order)
+        {
+            auto& op = plan->ops[(size_t) opIndices[(size_t) n]];
+
+            for (const auto& input : resolvedAudio[(size_t) n])
+                op.audioSources.push_back ({ opIndices[(size_t) input.node], input.channel, input.destChannel, input.gain });
+
+            std::stable_sort (op.audioSources.begin(), op.audioSources.end(),
+                              [] (const AudioSource& a, const AudioSource& b) { return a.destChannel < b.destChannel; });
+
+            for (auto src : resolvedMidi[(size_t) n])
+                op.midiSources.push_back (opIndices[(size_t) src]);
+        }
+
+        for (auto& op : plan->ops)
+            op.midi.ensureSize (4096);
+
+        for (size_t i = 0; i < plan->ops.size(); ++i)
+            if (i == 0 || plan->ops[i].level != plan->ops[i - 1].level)
+                plan->levelStarts.push_back ((int) i);
+
+        plan->levelStarts.push_back ((int) plan->ops.size());
+
+        allocateBuffers (*plan, blockSize, options.poolBuffers);
+
+        for (int l = 0; l < plan->getNumLevels(); ++l)
+            plan->maxLevelWidth = jmax (plan->maxLevelWidth, plan->levelStarts[(size_t) l + 1] - plan->levelStarts[(size_t) l]);
+
+        plan->topology = std::move (topology);
+        return plan;
+    }
+
+    RenderPlanDiagnostics RenderPlan::getDiagnostics() const
+    {
+        return { prunedNodes,
+                 foldedNodes,
+                 fusedChains,
+                 (int) ops.size(),
+                 getNumLevels(),
+                 bufferPool.getNumChannels(),
+                 (size_t) bufferPool.getNumChannels() * (size_t) maximumBlockSize * sizeof (float),
+                 numUnpooledBufferChannels,
+                 numInPlaceChannels };
+    }
+} // namespace PlayfulTones
@@ -0,0 +1,197 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /**
+        The gains of a graph's connections, shared with the render plans that apply them.
+
+        The first gain set on a connection needs a new plan; after that, a change is an atomic
+        store that the audio thread picks up on its next block. Must be used on the message thread.
+    */
+    class ConnectionGains
+    {
+    public:
+        /** Returns true if the connection had no gain before, so the plan must be recompiled. */
+        bool set (const AudioProcessorGraph::Connection&, float gain);
+
+        /** Returns 1 for connections without a gain. */
+        [[nodiscard]] float get (const AudioProcessorGraph::Connection&) const;
+
+        /** Returns nullptr for connections without a gain. */
+        [[nodiscard]] std::shared_ptr<const std::atomic<float>> find (const AudioProcessorGraph::Connection&) const;
+
+        void remove (const AudioProcessorGraph::Connection&);
+
+        /** Forgets the gains of connections that are no longer in the graph. */
+        void removeStale (const AudioProcessorGraph&);
+
+        [[nodiscard]] bool isEmpty() const noexcept    { return gains.empty(); }
+
+    private:
+        std::map<AudioProcessorGraph::Connection, std::shared_ptr<std::atomic<float>>> gains;
+    };
+
+    //==============================================================================
+    /**
+        A snapshot of the nodes and connections of an AudioProcessorGraph.
+
+        Holding the node pointers keeps the processors alive for as long as the
+        snapshot (or a RenderPlan compiled from it) exists.
+    */
+    struct GraphTopology
+    {
+        static GraphTopology capture (const AudioProcessorGraph&, const ConnectionGains* = nullptr);
+
+        bool operator== (const GraphTopology& other) const;
+        bool operator!= (const GraphTopology& other) const    { return ! operator== (other); }
+
+        /** Returns true if a node has been bypassed or un-bypassed since the snapshot was taken. */
+        [[nodiscard]] bool bypassStateHasChanged() const;
+
+        std::vector<AudioProcessorGraph::Node::Ptr> nodes;
+        std::vector<AudioProcessorGraph::Connection> connections;
+        std::vector<bool> bypassed;
+
+        /** The gain of each connection, or nullptr for unity. */
+        std::vector<std::shared_ptr<const std::atomic<float>>> gains;
+
+        /** How long the plan compiled from this snapshot fades in over the previous one.
+            Not part of the comparison.
+        */
+        int crossfadeSamples = 0;
+    };
+
+    /** Which nodes a render plan leaves out or merges, and how much buffer memory it uses. */
+    struct RenderPlanDiagnostics
+    {
+        /** Nodes that aren't processed because nothing they feed reaches an output. */
+        std::vector<AudioProcessorGraph::NodeID> prunedNodes;
+
+        /** Bypassed nodes whose inputs are handed straight to the nodes they feed. */
+        std::vector<AudioProcessorGraph::NodeID> foldedNodes;
+
+        /** Serial chains of nodes that are rendered as one op, in processing order. */
+        std::vector<std::vector<AudioProcessorGraph::NodeID>> fusedChains;
+
+        int numOps = 0;
+        int numLevels = 0;
+
+        /** The channels of the plan's buffer pool, which is all the intermediate audio it holds. */
+        int numBufferChannels = 0;
+        size_t bufferBytes = 0;
+
+        /** The channels the plan would hold if every op had buffers of its own. */
+        int numUnpooledBufferChannels = 0;
+
+        /** Op channels that are processed in the buffer of the node feeding them, without a copy. */
+        int numInPlaceChannels = 0;
+    };
+
+    //==============================================================================
+    /**
+        A compiled schedule for rendering a GraphTopology.
+
+        Ops are sorted by dependency level. An op only ever reads from ops in earlier
+        levels, so all ops within one level can be rendered concurrently.
+    */
+    struct RenderPlan
+    {
+        enum class OpType
+        {
+            processor,
+            audioInput,
+            audioOutput,
+            midiInput,
+            midiOutput
+        };
+
+        struct AudioSource
+        {
+            int op;
+            int channel;
+            int destChannel;
+            /** Read once per block, or nullptr for unity. */
+            const std::atomic<float>* gain = nullptr;
+            /** The source channel is the destination's buffer channel, so nothing is copied. */
+            bool isInPlace = false;
+        };
+
+        /** A node fused onto the end of an op, which processes the op's buffer in place. */
+        struct Stage
+        {
+            AudioProcessorGraph::Node::Ptr node;
+            AudioProcessor* processor = nullptr;
+            /** The channels from here on are cleared first, as the previous stage doesn't output them. */
+            int firstClearedChannel = 0;
+            /** False if the previous stage's MIDI isn't connected to this one, and must be cleared. */
+            bool keepsMidi = false;
+            std::shared_ptr<NodeProfiler::Entry> statistics;
+        };
+
+        struct Op
+        {
+            AudioProcessorGraph::Node::Ptr node;
+            AudioProcessor* processor = nullptr;
+            OpType type = OpType::processor;
+            int numChannels = 0;
+            int level = 0;
+            /** Sorted by destination channel, starting at channelSourceStarts[destChannel]. */
+            std::vector<AudioSource> audioSources;
+            std::vector<int> channelSourceStarts;
+            /** The channels and gains of audioSources, handed to FanInKernel as they are. */
+            std::vector<const float*> sourceChannels;
+            std::vector<float> sourceGains;
+            std::vector<int> midiSources;
+            /** Refers to channels of the plan's buffer pool, which other ops may use at other levels. */
+            AudioBuffer<float> buffer;
+            /** The buffer trimmed to the block being rendered, only re-pointed when the block length changes. */
+            AudioBuffer<float> view;
+            std::vector<bool> inPlaceChannels;
+            MidiBuffer midi;
+            std::shared_ptr<NodeProfiler::Entry> statistics;
+            std::vector<Stage> chain;
+        };
+
+        struct Options
+        {
+            /** Leave out the nodes whose output never reaches an output node or another sink. */
+            bool pruneDeadNodes = true;
+
+            /** Leave out bypassed nodes with matching input and output channels, wiring their inputs through. */
+            bool foldBypassedNodes = true;
+
+            /** Render chains of nodes that only feed each other as one op, over a single buffer. */
+            bool fuseChains = true;
+
+            /** Share buffer channels between ops whose lifetimes don't overlap, and let an op process
+                its input in place where the channel has no other reader.
+            */
+            bool poolBuffers = true;
+        };
+
+        /** Builds a plan for the given topology, with all buffers allocated up front. */
+        static std::unique_ptr<RenderPlan> compile (GraphTopology, int maximumBlockSize, const Options&);
+
+        [[nodiscard]] RenderPlanDiagnostics getDiagnostics() const;
+
+        [[nodiscard]] int getNumLevels() const    { return jmax (0, (int) levelStarts.size() - 1); }
+
+        GraphTopology topology;
+        std::vector<Op> ops;
+        std::vector<AudioProcessorGraph::NodeID> prunedNodes, foldedNodes;
+        std::vector<std::vector<AudioProcessorGraph::NodeID>> fusedChains;
+        std::vector<int> levelStarts;
+        AudioBuffer<float> bufferPool;
+        int numUnpooledBufferChannels = 0;
+        int numInPlaceChannels = 0;
+        int maxLevelWidth = 0;
+        int maximumBlockSize = 0;
+
+        /** When non-zero, the audio thread fades over from the previous plan for this many samples. */
+        int crossfadeSamples = 0;
+    };
+} // namespace PlayfulTones
@@ -0,0 +1,134 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+
+#pragma once
+using namespace juce;
+namespace PlayfulTones {
+    //==============================================================================
+    /**
+        A uniform grid over the bounding boxes of the items shown in the graph editor, so that
+        the items under a point or inside an area are found without walking all of them.
+
+        An item is listed in every cell its bounds touch. Cells are only created when
+        something lands in them, so the grid has no fixed extent.
+
+        The functions passed to the queries mustn't modify the grid.
+    */
+    template <typename Key, typename KeyHash = std::hash<Key>>
+    class SpatialGrid
+    {
+    public:
+        explicit SpatialGrid (float cellSizeToUse = 96.0f)
+            : cellSize (cellSizeToUse)
+        {
+            jassert (cellSize > 0.0f);
+        }
+
+        /** Adds an item, or moves it if it's already in the grid. */
+        void set (const Key& key, Rectangle<float> bounds)
+        {
+            remove (key);
+            items.emplace (key, bounds);
+            forEachCell (bounds, [&] (int64 cell) { cells[cell].emplace_back (key, bounds); });
+        }
+
+        void remove (const Key& key)
+        {
+            const auto it = items.find (key);
+
+            if (it == items.end())
+                return;
+
+            forEachCell (it->second, [&] (int64 cell)
+            {
+                if (const auto c = cells.find (cell); c != cells.end())
+                {
+                    auto& entries = c->second;
+                    entries.erase (std::remove_if (entries.begin(), entries.end(),
+                                                   [&] (const Entry& e) { return e.first == key; }),
+                                   entries.end());
+
+                    if (entries.empty())
+                        cells.erase (c);
+                }
+            });
+
+            items.erase (it);
+        }
+
+        void clear()
+        {
+            items.clear();
+            cells.clear();
+        }
+
+        [[nodiscard]] bool contains (const Key& key) const     { return items.find (key) != items.end(); }
+        [[nodiscard]] size_t size() const noexcept             { return items.size(); }
+
+        /** Calls fn (key, bounds) for each item whose bounds contain the point. */
+        template <typename Function>
+        void forEachAt (Point<float> point, Function&& fn) const
+        {
+            if (const auto c = cells.find (getCell (point)); c != cells.end())
+                for (const auto& [key, bounds] : c->second)
+                    if (bounds.contains (point))
+                        fn (key, bounds);
+        }
+
+        /** Calls fn (key, bounds) once for each item whose bounds intersect the area. */
+        template <typename Function>
+        void forEachIn (Rectangle<float> area, Function&& fn) const
+        {
+            forEachCell (area, [&] (int64 cell)
+            {
+                if (const auto c = cells.find (cell); c != cells.end())
+                {
+                    for (const auto& [key, bounds] : c->second)
+                    {
+                        if (! bounds.intersects (area))
+                            continue;
+
+                        // an item that spans several cells is only reported by the cell
+                        // holding the corner of its overlap with the area
+                        if (getCell (bounds.getIntersection (area).getTopLeft()) == cell)
+                            fn (key, bounds);
+                    }
+                }
+            });
+        }
+
+    private:
+        using Entry = std::pair<Key, Rectangle<float>>;
+
+        [[nodiscard]] int getCellCoordinate (float v) const noexcept
+        {
+            return (int) std::floor (v / cellSize);
+        }
+
+        [[nodiscard]] static int64 makeCell (int x, int y) noexcept
+        {
+            return (int64) (((uint64) (uint32) x << 32) | (uint64) (uint32) y);
+        }
+
+        [[nodiscard]] int64 getCell (Point<float> p) const noexcept
+        {
+            return makeCell (getCellCoordinate (p.x), getCellCoordinate (p.y));
+        }
+
+        template <typename Function>
+        void forEachCell (Rectangle<float> bounds, Function&& fn) const
+        {
+            const auto x0 = getCellCoordinate (bounds.getX()), x1 = getCellCoordinate (bounds.getRight());
+            const auto y0 = getCellCoordinate (bounds.getY()), y1 = getCellCoordinate (bounds.getBottom());
+
+            for (auto x = x0; x <= x1; ++x)
+                for (auto y = y0; y <= y1; ++y)
+                    fn (makeCell (x, y));
+        }
+
+        const float cellSize;
+        std::unordered_map<Key, Rectangle<float>, KeyHash> items;
+        std::unordered_map<int64, std::vector<Entry>> cells;
+    };
+} // namespace PlayfulTones
@@ -0,0 +1,233 @@
+//
+// Created by Bence Kovács on 16/10/2026.
+//
+// Unit tests for ProcessorGraph. Exits with a non-zero code if any test fails.
+//
+// Usage: ProcessorGraphTests
+//
+
+#include <playfultones_processorgraph/playfultones_processorgraph.h>
+
+using namespace juce;
+using namespace PlayfulTones;
+
+namespace PlayfulTones::Tests {
+    //==============================================================================
+    /** A stereo processor that passes its input through. */
+    class PassThroughProcessor final : public AudioProcessor
+    {
+    public:
+        PassThroughProcessor()
+            : AudioProcessor (BusesProperties().withInput ("Input", AudioChannelSet::stereo())
+                                               .withOutput ("Output", AudioChannelSet::stereo()))
+        {
+        }
+
+        const String getName() const override                 { return "Pass-through"; }
+
+        void prepareToPlay (double, int) override              {}
+        void releaseResources() override                       {}
+        void processBlock (AudioBuffer<float>&, MidiBuffer&) override {}
+
+        double getTailLengthSeconds() const override           { return 0.0; }
+        bool acceptsMidi() const override                      { return false; }
+        bool producesMidi() const override                     { return false; }
+        AudioProcessorEditor* createEditor() override          { return nullptr; }
+        bool hasEditor() const override                        { return false; }
+        int getNumPrograms() override                          { return 1; }
+        int getCurrentProgram() override                       { return 0; }
+        void setCurrentProgram (int) override                  {}
+        const String getProgramName (int) override             { return {}; }
+        void changeProgramName (int, const String&) override   {}
+        void getStateInformation (MemoryBlock&) override       {}
+        void setStateInformation (const void*, int) override   {}
+    };
+
+    static ModuleFactory createFactory()
+    {
+        return ModuleFactory { [] { return std::make_unique<PassThroughProcessor>(); } };
+    }
+
+    //==============================================================================
+    /** Records the edit notifications a ProcessorGraph sends, in the order they arrive. */
+    struct EditLog final : public ProcessorGraph::Listener
+    {
+        static String describe (ProcessorGraph::NodeID nodeID)
+        {
+            return "node " + String (nodeID.uid);
+        }
+
+        static String describe (const AudioProcessorGraph::Connection& c)
+        {
+            return "connection " + String (c.source.nodeID.uid) + "." + String (c.source.channelIndex)
+                 + " > " + String (c.destination.nodeID.uid) + "." + String (c.destination.channelIndex);
+        }
+
+        void nodeAdded (ProcessorGraph::NodeID nodeID) override                          { events.add ("+" + describe (nodeID)); }
+        void nodeRemoved (ProcessorGraph::NodeID nodeID) override                        { events.add ("-" + describe (nodeID)); }
+        void connectionAdded (const AudioProcessorGraph::Connection& c) override         { events.add ("+" + describe (c)); }
+        void connectionRemoved (const AudioProcessorGraph::Connection& c) override       { events.add ("-" + describe (c)); }
+
+        void changesCommitted (const ProcessorGraph::ChangeSet& changes) override
+        {
+            events.add ("commit");
+            ProcessorGraph::Listener::changesCommitted (changes);
+        }
+
+        StringArray events;
+    };
+
+    //==============================================================================
+    class TransactionTests final : public UnitTest
+    {
+    public:
+        TransactionTests() : UnitTest ("ProcessorGraph transactions", "PlayfulTones") {}
+
+        void runTest() override
+        {
+            beginTest ("Edits outside a transaction are reported as they happen");
+            {
+                ProcessorGraph graph (createFactory());
+                EditLog log;
+                graph.addListener (&log);
+
+                const auto a = graph.createModule (0)->nodeID;
+                const auto b = graph.createModule (0)->nodeID;
+                const AudioProcessorGraph::Connection ab { { a, 0 }, { b, 0 } };
+
+                graph.addConnection (ab);
+                graph.removeConnection (ab);
+                graph.removeNode (a);
+                graph.removeNode (b);
+
+                graph.removeListener (&log);
+
+                expectEvents (log, { "+" + EditLog::describe (a), "+" + EditLog::describe (b),
+                                     "+" + EditLog::describe (ab), "-" + EditLog::describe (ab),
+                                     "-" + EditLog::describe (a), "-" + EditLog::describe (b) });
+            }
+
+            beginTest ("A transaction that undoes its own edits reports nothing");
+            {
+                ProcessorGraph graph (createFactory());
+                EditLog log;
+                graph.addListener (&log);
+
+                {
+                    const ProcessorGraph::ScopedTransaction transaction (graph);
+                    const auto a = graph.createModule (0)->nodeID;
+                    const auto b = graph.createModule (0)->nodeID;
+                    const AudioProcessorGraph::Connection ab { { a, 0 }, { b, 0 } };
+
+                    graph.addConnection (ab);
+                    graph.removeConnection (ab);
+                    graph.removeNode (a);
+                    graph.removeNode (b);
+                }
+
+                graph.removeListener (&log);
+
+                expectEvents (log, {});
+            }
+
+            beginTest ("Removing a node drops the connections queued for it");
+            {
+                ProcessorGraph graph (createFactory());
+                const auto a = graph.createModule (0)->nodeID;
+
+                EditLog log;
+                graph.addListener (&log);
+
+                {
+                    const ProcessorGraph::ScopedTransaction transaction (graph);
+                    const auto b = graph.createModule (0)->nodeID;
+                    graph.addConnection ({ { a, 0 }, { b, 0 } });
+                    graph.addConnection ({ { a, 1 }, { b, 1 } });
+                    graph.removeNode (b);
+                }
+
+                graph.removeListener (&log);
+
+                expectEvents (log, {});
+            }
+
+            beginTest ("A transaction reports its net changes once, removals first");
+            {
+                ProcessorGraph graph (createFactory());
+                const auto a = graph.createModule (0)->nodeID;
+                const auto b = graph.createModule (0)->nodeID;
+                const AudioProcessorGraph::Connection ab { { a, 0 }, { b, 0 } };
+                graph.addConnection (ab);
+
+                EditLog log;
+                graph.addListener (&log);
+
+                ProcessorGraph::NodeID c;
+                {
+                    const ProcessorGraph::ScopedTransaction transaction (graph);
+                    c = graph.createModule (0)->nodeID;
+                    graph.removeConnection (ab);
+                    graph.removeNode (a);
+                    graph.addConnection ({ { c, 0 }, { b, 0 } });
+                }
+
+                graph.removeListener (&log);
+
+                expectEvents (log, { "commit",
+                                     "-" + EditLog::describe (ab),
+                                     "-" + EditLog::describe (a),
+                                     "+" + EditLog::describe (c),
+                                     "+" + EditLog::describe (AudioProcessorGraph::Connection { { c, 0 }, { b, 0 } }) });
+            }
+
+            beginTest ("Only the outermost of nested transactions commits");
+            {
+                ProcessorGraph graph (createFactory());
+                EditLog log;
+                graph.addListener (&log);
+
+                ProcessorGraph::NodeID a;
+                {
+                    const ProcessorGraph::ScopedTransaction outer (graph);
+
+                    {
+                        const ProcessorGraph::ScopedTransaction inner (graph);
+                        a = graph.createModule (0)->nodeID;
+                    }
+
+                    expectEvents (log, {});
+                }
+
+                graph.removeListener (&log);
+
+                expectEvents (log, { "commit", "+" + EditLog::describe (a) });
+            }
+        }
+
+    private:
+        void expectEvents (const EditLog& log, const StringArray& expected)
+        {
+            expect (log.events == expected, "got [" + log.events.joinIntoString (", ")
+                                             + "], expected [" + expected.joinIntoString (", ") + "]");
+        }
+    };
+
+    static TransactionTests transactionTests;
+} // namespace PlayfulTones::Tests
+
+//==============================================================================
+int main()
+{
+    // creates the message manager without opening a display connection
+    const ScopedJuceInitialiser_GUI juceInitialiser;
+
+    UnitTestRunner runner;
+    runner.setAssertOnFailure (false);
+    runner.runTestsInCategory ("PlayfulTones");
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        if (runner.getResult (i)->failures > 0)
+            return 1;
+
+    return 0;
+}